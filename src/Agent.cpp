@@ -1,5 +1,10 @@
 #include "Agent.h"
 #include "Config.h"
+#include "MoveOrdering.h"
+#include "PerfCounters.h"
+#include "SGFWriter.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 #define MIN_SCORE -32768
@@ -7,43 +12,255 @@
 
 std::pair<uint16_t, int16_t> Agent::get_best_move(Board b, uint8_t depth)
 {
-    // todo: make hash table for best moves
-    assert(depth > 0);
-    std::pair<uint16_t, int16_t> results = alphabeta(Board(b), depth, MIN_SCORE, MAX_SCORE);
+    return search(b, depth, 0);
+}
+
+std::pair<uint16_t, int16_t> Agent::search(Board b, uint8_t max_depth, double seconds, uint64_t max_nodes)
+{
+    TRACE_SCOPE("get_best_move", max_depth);
+    PERF_REGION(REGION_SEARCH);
+#if SEARCH_STATS
+    SearchStats start = thread_search_stats();
+#endif
+    std::pair<uint16_t, int16_t> results(PASS, static_score(b));
+    for (const SearchUpdate &update : iterate(b, max_depth, seconds, max_nodes))
+    {
+        results = std::pair<uint16_t, int16_t>(update.move, update.score);
+    }
+#if SEARCH_STATS
+    last_search_stats = thread_search_stats().since(start);
+#endif
     return results;
 }
 
+Generator<SearchUpdate> Agent::iterate(Board b, uint8_t max_depth, double seconds, uint64_t max_nodes)
+{
+    assert(max_depth > 0);
+    // cleared here rather than in the coroutine, whose body only starts on begin(), so a stop requested
+    // in between isn't lost
+    stop_requested.store(false, std::memory_order_relaxed);
+    stopped = false;
+    has_deadline = false;
+    node_limit = 0;
+    return iterations(b, max_depth, seconds, max_nodes);
+}
+
+Generator<SearchUpdate> Agent::iterations(Board b, uint8_t max_depth, double seconds, uint64_t max_nodes)
+{
+    // runs when the loop ends and also when the caller drops the generator while it is suspended
+    struct LimitReset
+    {
+        Agent &agent;
+        ~LimitReset()
+        {
+            agent.has_deadline = false;
+            agent.node_limit = 0;
+            agent.stopped = false;
+        }
+    } reset{*this};
+    auto start_time = std::chrono::steady_clock::now();
+    uint64_t start_nodes = node_count;
+    uint16_t book_move;
+    if (book && book->probe(b, book_move))
+    {
+        Board after = b;
+        if (after.make_play(book_move))
+        {
+            SearchUpdate update{0, book_move, static_score(after), std::vector<uint16_t>(1, book_move), 0, 0};
+            co_yield update;
+            co_return;
+        }
+    }
+
+    deadline = start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    has_deadline = seconds > 0;
+    node_limit = max_nodes ? node_count + max_nodes : 0;
+    completed_depth = 0;
+    if (tt)
+    {
+        tt->new_generation();
+    }
+
+    // deepening only pays off when the transposition table carries each iteration's best moves into the next
+    for (uint8_t depth = tt || has_deadline || node_limit ? 1 : max_depth; depth <= max_depth; depth++)
+    {
+        std::pair<uint16_t, int16_t> iteration;
+        {
+            TRACE_SCOPE("iteration", depth);
+            root_depth = depth;
+            iteration = alphabeta(b, depth, MIN_SCORE, MAX_SCORE);
+        }
+        if (stopped)
+        {
+            break;
+        }
+        completed_depth = depth;
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+        SearchUpdate update{depth, iteration.first, iteration.second, std::vector<uint16_t>(1, iteration.first), node_count - start_nodes, elapsed};
+        Board after = b;
+        if (after.make_play(iteration.first))
+        {
+            std::vector<uint16_t> rest = principal_variation(after, depth - 1);
+            update.pv.insert(update.pv.end(), rest.begin(), rest.end());
+        }
+        // suspended here until the caller wants the next iteration, the deadline keeps running meanwhile
+        co_yield update;
+        if (stop_requested.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+        // the next iteration takes several times longer than this one, don't start one that can't finish
+        if (has_deadline && elapsed > seconds / 2)
+        {
+            break;
+        }
+    }
+}
+
+void Agent::request_stop()
+{
+    stop_requested.store(true, std::memory_order_relaxed);
+}
+
+std::vector<uint16_t> Agent::principal_variation(Board b, uint8_t max_length) const
+{
+    std::vector<uint16_t> pv;
+    TTEntry entry;
+    // entries can be overwritten by other searches sharing the table, so the line may end early but
+    // every move in it is legal
+    uint8_t symmetry;
+    while (tt && pv.size() < max_length && tt->probe(b.get_canonical_key(symmetry), entry))
+    {
+        uint16_t move = Board::inverse_transform_point(symmetry, entry.move);
+        if (move == PASS || !b.make_play(move))
+        {
+            break;
+        }
+        pv.push_back(move);
+    }
+    return pv;
+}
+
+int16_t Agent::evaluate(Board b, uint8_t depth)
+{
+    int16_t value = static_score(b);
+    for (uint8_t d = tt ? 1 : depth; d <= depth; d++)
+    {
+        TRACE_SCOPE("iteration", d);
+        // one above d so b itself can be answered from the table, there is no move to return here
+        root_depth = d + 1;
+        value = alphabeta(b, d, MIN_SCORE, MAX_SCORE).second;
+    }
+    return value;
+}
+
 std::pair<uint16_t, int16_t> Agent::alphabeta(Board b, uint8_t depth, int16_t alpha, int16_t beta)
 {
+    node_count++;
+#if SEARCH_STATS
+    uint8_t ply = std::min(root_depth > depth ? root_depth - depth : 0, MAX_PLY - 1);
+    STATS_INC(nodes_per_ply[ply]);
+    uint16_t candidate_index = 0;
+#endif
+    // the first iteration always finishes so there is a move to fall back on
+    if (completed_depth > 0 && (node_count & 1023) == 0)
+    {
+        bool out_of_nodes = node_limit && node_count >= node_limit;
+        if (out_of_nodes || stop_requested.load(std::memory_order_relaxed) || (has_deadline && std::chrono::steady_clock::now() > deadline))
+        {
+            stopped = true;
+        }
+    }
+    if (stopped)
+    {
+        return std::pair<uint16_t, int16_t>(PASS, 0);
+    }
     if (depth < 1)
     {
-        return std::pair<uint16_t, int16_t>(0, b.score());
+        return std::pair<uint16_t, int16_t>(0, static_score(b));
     }
+
+    // rotations and reflections of a position share an entry, its move is kept in the stored orientation
+    uint64_t key = 0;
+    uint8_t symmetry = 0;
+    uint16_t hash_move = PASS;
+    if (tt)
+    {
+        key = b.get_canonical_key(symmetry);
+        TTEntry entry;
+        STATS_INC(tt_probes);
+        if (tt->probe(key, entry))
+        {
+            STATS_INC(tt_hits);
+            hash_move = Board::inverse_transform_point(symmetry, entry.move);
+            // the root always searches so it returns a move for this exact position
+            bool usable = entry.bound == TT_EXACT || (entry.bound == TT_LOWER && entry.score >= beta) || (entry.bound == TT_UPPER && entry.score <= alpha);
+            if (depth < root_depth && entry.depth >= depth && usable)
+            {
+                STATS_INC(tt_cutoffs);
+                return std::pair<uint16_t, int16_t>(hash_move, entry.score);
+            }
+        }
+    }
+    int16_t alpha_start = alpha;
+    int16_t beta_start = beta;
+
     int16_t value = 0;
     uint16_t best_move = PASS;
     value = b.whose_turn() ? MIN_SCORE : MAX_SCORE;
-    for (int idx = 0; idx < 361; idx++)
+    std::array<uint16_t, BOARD_SIZE * BOARD_SIZE> candidates;
+    uint16_t num_candidates = 0;
+    for (uint16_t i : move_checking_order(b.get_play_count()))
     {
-        int i = optimal_move_checking_order[idx];
         if (b.get_point(i) == pointType::EMPTY)
         {
-            if (b.whose_turn())
-            {
-                if (evaluate_move_black(b, i, depth, alpha, beta, value, best_move))
-                {
-                    break;
-                }
-            }
-            else
-            {
-                if (evaluate_move_white(b, i, depth, alpha, beta, value, best_move))
-                {
-                    break;
-                }
-            }
+            candidates[num_candidates++] = i;
+        }
+    }
+    // pattern lookups cost about as much as a leaf, so only reorder where whole subtrees are at stake
+    if (patterns && depth >= 2)
+    {
+        patterns->order_moves(b, candidates.data(), num_candidates);
+    }
+    if (hash_move != PASS)
+    {
+        uint16_t *found = std::find(candidates.data(), candidates.data() + num_candidates, hash_move);
+        std::rotate(candidates.data(), found, found + (found != candidates.data() + num_candidates));
+    }
+
+    for (uint16_t c = 0; c < num_candidates; c++)
+    {
+        uint16_t i = candidates[c];
+        bool cutoff = b.whose_turn() ? evaluate_move_black(b, i, depth, alpha, beta, value, best_move)
+                                     : evaluate_move_white(b, i, depth, alpha, beta, value, best_move);
+        if (stopped)
+        {
+            return std::pair<uint16_t, int16_t>(best_move, value);
+        }
+#if SEARCH_STATS
+        if (cutoff)
+        {
+            STATS_INC(cutoffs_per_ply[ply]);
+            STATS_INC(cutoff_move_index[candidate_index]);
+        }
+        candidate_index++;
+#endif
+        if (cutoff)
+        {
+            break;
         }
     }
 
+    if (tt)
+    {
+        ttBound bound = value <= alpha_start ? TT_UPPER : TT_EXACT;
+        if (value >= beta_start)
+        {
+            bound = TT_LOWER;
+        }
+        tt->store(key, Board::transform_point(symmetry, best_move), value, depth, bound);
+    }
     return std::pair<uint16_t, int16_t>(best_move, value);
 }
 
@@ -97,16 +314,68 @@ Agent::Agent() : b()
 {
 }
 
-void Agent::play(uint8_t depth, uint16_t move_limit)
+uint64_t Agent::get_node_count() const
+{
+    return node_count;
+}
+
+void Agent::reset_node_count()
+{
+    node_count = 0;
+}
+
+const SearchStats &Agent::get_search_stats() const
+{
+    return last_search_stats;
+}
+
+void Agent::set_book(std::shared_ptr<const OpeningBook> book)
+{
+    this->book = book;
+}
+
+void Agent::set_patterns(std::shared_ptr<const PatternTable> patterns)
+{
+    this->patterns = patterns;
+}
+
+void Agent::set_evaluator(std::shared_ptr<const Evaluator> evaluator)
+{
+    this->evaluator = evaluator;
+}
+
+int16_t Agent::static_score(const Board &b) const
+{
+    return evaluator ? evaluator->evaluate(b) : b.score();
+}
+
+void Agent::set_transposition_table(std::shared_ptr<TranspositionTable> tt)
 {
+    this->tt = tt;
+}
+
+uint8_t Agent::get_completed_depth() const
+{
+    return completed_depth;
+}
+
+void Agent::play(uint8_t depth, uint16_t move_limit, GameLog &log, const std::string &sgf_path)
+{
+    // kept as a record so the game can be saved while it is still going
+    GameRecord record;
+    record.komi = komi;
+    SGFGameInfo info{"stella", "stella", ""};
     bool white_pass = false;
     bool black_pass = false;
     for (uint16_t i = 0; i < move_limit; i++)
     {
         std::pair<uint16_t, int16_t> best_move = get_best_move(b, depth);
+#if SEARCH_STATS
+        last_search_stats.print();
+#endif
         if (best_move.first == PASS)
         {
-            printf("PASS\n\n");
+            log.write(LOG_MOVES, "PASS\n\n");
             if (b.whose_turn())
             {
                 black_pass = true;
@@ -117,15 +386,36 @@ void Agent::play(uint8_t depth, uint16_t move_limit)
             }
             if (black_pass && white_pass)
             {
-                int16_t score = b.score();
-                std::cout << "GAME OVER: " << ((score > 0) ? "BLACK" : "WHITE") << " wins!" << '\n';
-                printf("Move: %u\tScore: %d\n", i, score);
-                b.print_board();
+                // area scoring with komi, the same rule as RE and GTP final_score
+                float margin = b.area_score() - komi;
+                log.write(LOG_RESULTS, std::string("GAME OVER: ") + (margin > 0 ? "BLACK wins!" : margin < 0 ? "WHITE wins!" : "DRAW!") +
+                                           "\nMove: " + std::to_string(i) + "\tScore: " + sgf_result(margin) + "\n");
+                if (log.enabled(LOG_BOARDS))
+                {
+                    log.write(LOG_BOARDS, b.to_string());
+                }
+                if (!sgf_path.empty())
+                {
+                    record.moves.push_back(PASS);
+                    info.result = sgf_result(margin);
+                    log.write_file(sgf_path, format_sgf(record, info));
+                }
                 return;
             }
         }
         assert(b.make_play(best_move.first));
-        printf("Move: %u\tScore: %d\n", i, b.score());
-        b.print_board();
+        record.moves.push_back(best_move.first);
+        if (log.enabled(LOG_MOVES))
+        {
+            log.write(LOG_MOVES, "Move: " + std::to_string(i) + "\tScore: " + std::to_string(b.score()) + "\n");
+        }
+        if (log.enabled(LOG_BOARDS))
+        {
+            log.write(LOG_BOARDS, b.to_string());
+        }
+        if (!sgf_path.empty())
+        {
+            log.write_file(sgf_path, format_sgf(record, info));
+        }
     }
 }
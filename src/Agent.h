@@ -1,10 +1,45 @@
-
+#ifndef AGENT_H
+#define AGENT_H
 #include "Board.h"
+#include "Evaluator.h"
+#include "GameLog.h"
+#include "Generator.h"
+#include "OpeningBook.h"
+#include "Patterns.h"
+#include "TranspositionTable.h"
+#include "SearchStats.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct SearchUpdate
+{
+    uint8_t depth; // 0 for a book move
+    uint16_t move;
+    int16_t score;
+    std::vector<uint16_t> pv; // starts with move, longer only with a transposition table
+    uint64_t nodes;           // since the search started
+    double seconds;
+};
 
 class Agent
 {
 public:
     std::pair<uint16_t, int16_t> get_best_move(Board b, uint8_t depth);
+    // deepens one ply at a time up to max_depth, stopping after about seconds or max_nodes (0 for no limit)
+    std::pair<uint16_t, int16_t> search(Board b, uint8_t max_depth, double seconds, uint64_t max_nodes = 0);
+    // the same search as a generator, yielding after every completed iteration; the agent has to outlive it
+    Generator<SearchUpdate> iterate(Board b, uint8_t max_depth, double seconds = 0, uint64_t max_nodes = 0);
+    // ends the running or suspended search at the next check, safe to call from any thread; the first
+    // iteration still finishes so there is always a move
+    void request_stop();
+    // moves stored in the transposition table from b on, at most max_length of them
+    std::vector<uint16_t> principal_variation(Board b, uint8_t max_length) const;
+    // full window value of b to depth, deepening through the transposition table when there is one
+    int16_t evaluate(Board b, uint8_t depth);
     std::pair<uint16_t, int16_t> alphabeta(Board b, uint8_t depth, int16_t alpha, int16_t beta);
     bool evaluate_move_white(Board b, int i, uint8_t depth, int16_t alpha, int16_t &beta, int16_t &value, uint16_t &best_move);
     bool evaluate_move_black(Board b, int i, uint8_t depth, int16_t &alpha, int16_t beta, int16_t &value, uint16_t &best_move);
@@ -12,8 +47,46 @@ public:
     bool no_legal_moves(Board b);
     Agent();
 
-    void play(uint8_t depth, uint16_t move_limit);
+    uint64_t get_node_count() const;
+    void reset_node_count();
+    // counters for the most recent get_best_move, all zero unless SEARCH_STATS is on
+    const SearchStats &get_search_stats() const;
+    // positions found in the book are answered without searching
+    void set_book(std::shared_ptr<const OpeningBook> book);
+    // corpus shape priors reorder the candidate moves near the root
+    void set_patterns(std::shared_ptr<const PatternTable> patterns);
+    // tuned weights for the leaves, Board::score without one
+    void set_evaluator(std::shared_ptr<const Evaluator> evaluator);
+    // kept between searches, so later searches start from what earlier ones found
+    void set_transposition_table(std::shared_ptr<TranspositionTable> tt);
+    // deepest iteration the last search finished
+    uint8_t get_completed_depth() const;
+
+    // self-play from the current position, progress goes to log and with sgf_path the game is saved
+    // there after every move
+    void play(uint8_t depth, uint16_t move_limit, GameLog &log, const std::string &sgf_path = "");
 
 protected:
+    int16_t static_score(const Board &b) const;
+
     Board b;
-};
\ No newline at end of file
+    uint64_t node_count = 0; // positions visited by alphabeta since the last reset
+    uint8_t root_depth = 0;
+    SearchStats last_search_stats;
+    std::shared_ptr<const OpeningBook> book;
+    std::shared_ptr<const PatternTable> patterns;
+    std::shared_ptr<const Evaluator> evaluator;
+    std::shared_ptr<TranspositionTable> tt;
+
+    uint8_t completed_depth = 0;
+    bool has_deadline = false;
+    uint64_t node_limit = 0; // node_count at which the search stops, 0 for none
+    bool stopped = false; // set once the deadline passes, unwinds the search without storing results
+    std::atomic<bool> stop_requested{false};
+    std::chrono::steady_clock::time_point deadline;
+
+    // the body of iterate, which resets the stop state before handing it out
+    Generator<SearchUpdate> iterations(Board b, uint8_t max_depth, double seconds, uint64_t max_nodes);
+};
+
+#endif
@@ -3,6 +3,8 @@
 #include <cmath>
 
 #include "Board.h"
+#include "PerfCounters.h"
+#include "SearchStats.h"
 
 Board::Board()
 {
@@ -23,20 +25,7 @@ Board::Board()
     this->directions = {-BOARD_SIZE - 2, -1, BOARD_SIZE + 2, 1};
     this->diagonals = {-BOARD_SIZE - 3, -BOARD_SIZE - 1, BOARD_SIZE + 1, BOARD_SIZE + 3};
 
-    zobrist = 0; // empty board state
-
-    // set up random 64 bitstring generator
-    std::random_device rd;
-
-    std::mt19937_64 e2(rd());
-
-    std::uniform_int_distribution<long long int> dist(std::llround(std::pow(2, 61)), std::llround(std::pow(2, 62)));
-
-    for (uint16_t i = 0; i < NUM_POINTS; i++)
-    {
-        zobrist_hashes_black[i] = dist(e2);
-        zobrist_hashes_white[i] = dist(e2);
-    }
+    zobrist.fill(0); // empty board state
 
     black_count = 0;
     white_count = 0;
@@ -60,8 +49,9 @@ uint16_t Board::get_liberties(uint16_t idx) const
     return num_liberties;
 }
 
-void Board::print_board() const
+std::string Board::to_string() const
 {
+    std::string text;
     for (uint16_t i = 0; i < (BOARD_SIZE + 2); i++)
     {
         for (uint16_t j = 0; j < (BOARD_SIZE + 2); j++)
@@ -69,28 +59,28 @@ void Board::print_board() const
             switch (board[i * (BOARD_SIZE + 2) + j])
             {
             case pointType::BLANK:
-                std::cout << "# ";
+                text += "# ";
                 break;
             case pointType::EMPTY:
-                if (is_eye(i * (BOARD_SIZE + 2) + j))
-                {
-                    std::cout << "* ";
-                    break;
-                }
-                std::cout << "  ";
+                text += is_eye(i * (BOARD_SIZE + 2) + j) ? "* " : "  ";
                 break;
             case pointType::BLACK:
-                std::cout << "○ ";
+                text += "○ ";
                 break;
             case pointType::WHITE:
-                std::cout << "● ";
+                text += "● ";
                 break;
             }
         }
-
-        std::cout << std::endl;
+        text += '\n';
     }
-    std::cout << std::endl;
+    text += '\n';
+    return text;
+}
+
+void Board::print_board() const
+{
+    std::cout << to_string() << std::flush;
 #if DEBUG
 #if VERBOSE
     std::cout << "Chain Roots" << std::endl;
@@ -174,11 +164,51 @@ void Board::print_board() const
 
 uint64_t Board::get_hash() const
 {
-    return zobrist;
+    return zobrist[0];
+}
+
+uint64_t Board::get_position_key() const
+{
+    return whose_turn() ? zobrist[0] : zobrist[0] ^ zobrist_white_to_move;
+}
+
+uint64_t Board::get_symmetric_hash(uint8_t symmetry) const
+{
+    return zobrist[symmetry];
+}
+
+uint64_t Board::get_canonical_hash(uint8_t &symmetry) const
+{
+    symmetry = 0;
+    for (uint8_t t = 1; t < NUM_SYMMETRIES; t++)
+    {
+        if (zobrist[t] < zobrist[symmetry])
+        {
+            symmetry = t;
+        }
+    }
+    return zobrist[symmetry];
+}
+
+uint64_t Board::get_canonical_key(uint8_t &symmetry) const
+{
+    uint64_t hash = get_canonical_hash(symmetry);
+    return whose_turn() ? hash : hash ^ zobrist_white_to_move;
+}
+
+uint16_t Board::transform_point(uint8_t symmetry, uint16_t idx)
+{
+    return symmetries[symmetry][idx];
+}
+
+uint16_t Board::inverse_transform_point(uint8_t symmetry, uint16_t idx)
+{
+    return inverse_symmetries[symmetry][idx];
 }
 
 bool Board::make_play(uint16_t idx)
 {
+    PERF_REGION(REGION_MAKE_PLAY);
     if (idx == PASS)
     {
         play_count++;
@@ -213,6 +243,7 @@ bool Board::make_play(uint16_t idx)
 #endif
         return true;
     }
+    STATS_INC(illegal_plays);
     return false;
 }
 
@@ -221,12 +252,27 @@ bool Board::whose_turn() const
     return (play_count & 1) == 0;
 }
 
+uint16_t Board::get_stone_count(bool black) const
+{
+    return black ? black_count : white_count;
+}
+
+uint16_t Board::get_chain_liberties(uint16_t idx) const
+{
+    return chain_liberties[chain_roots[idx]];
+}
+
 uint16_t Board::get_play_count() const
 {
     return play_count;
 }
 
 void Board::check_for_errors() const
+{
+    assert(is_consistent());
+}
+
+bool Board::is_consistent() const
 {
     std::array<uint16_t, NUM_POINTS> liberties_check{};
     std::array<uint16_t, NUM_POINTS> sizes_check{};
@@ -240,12 +286,10 @@ void Board::check_for_errors() const
         case pointType::WHITE:
             sizes_check[chain_roots[i]]++;
 
-            assert(chain_roots[i] != 0);
-            if (chain_liberties[chain_roots[i]] == 0)
+            if (chain_roots[i] == 0 || chain_liberties[chain_roots[i]] == 0 || chain_sizes[chain_roots[i]] == 0)
             {
-                assert(false);
+                return false;
             }
-            assert(chain_sizes[chain_roots[i]] != 0);
             break;
         case pointType::EMPTY:
             std::array<uint16_t, 4> past_chains{};
@@ -283,14 +327,10 @@ void Board::check_for_errors() const
     {
         // std::cout << i << " " << liberties_check[i] << " " << chain_liberties[i] << '\n';
         // std::cout << i << " " << sizes_check[i] << " " << chain_sizes[i] << '\n';
-        if (liberties_check[i] != chain_liberties[i])
+        if (liberties_check[i] != chain_liberties[i] || sizes_check[i] != chain_sizes[i])
         {
-            assert(false);
-        }
-        if (sizes_check[i] != chain_sizes[i])
-        {
-
-            assert(false);
+            return false;
         }
     }
+    return true;
 }
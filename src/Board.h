@@ -6,6 +6,7 @@
 // #include <vector>
 #include <array>
 #include <cassert>
+#include <string>
 
 enum pointType
 {
@@ -15,12 +16,102 @@ enum pointType
     WHITE = 3
 };
 
+enum playError
+{
+    PLAY_OK = 0,
+    PLAY_OCCUPIED = 1,
+    PLAY_SUICIDE = 2,
+    PLAY_KO = 3
+};
+
 #define NORTH 1        // 00000001
 #define WEST (1 << 1)  // 00000010
 #define SOUTH (1 << 2) // 00000100
 #define EAST (1 << 3)  // 00001000
 #define COUNT (7 << 4) // 01110000
 
+// zobrist keys come from a fixed seed so hashes are identical in every run and can be stored in files
+static constexpr uint64_t ZOBRIST_SEED = 0x5354454c4c41474f;
+
+constexpr std::array<uint64_t, NUM_POINTS> zobrist_table(uint64_t seed)
+{
+    // splitmix64
+    std::array<uint64_t, NUM_POINTS> table{};
+    uint64_t state = seed;
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        state += 0x9e3779b97f4a7c15;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        table[i] = z ^ (z >> 31);
+    }
+    return table;
+}
+
+static constexpr uint8_t NUM_SYMMETRIES = 8;
+
+// symmetry t flips x with bit 0 and y with bit 1, then swaps them with bit 2; border points stay put, and
+// with them PASS and RESIGN
+constexpr std::array<std::array<uint16_t, NUM_POINTS>, NUM_SYMMETRIES> symmetry_tables()
+{
+    std::array<std::array<uint16_t, NUM_POINTS>, NUM_SYMMETRIES> tables{};
+    for (uint8_t t = 0; t < NUM_SYMMETRIES; t++)
+    {
+        for (uint16_t i = 0; i < NUM_POINTS; i++)
+        {
+            tables[t][i] = i;
+        }
+        for (uint16_t y = 0; y < BOARD_SIZE; y++)
+        {
+            for (uint16_t x = 0; x < BOARD_SIZE; x++)
+            {
+                uint16_t tx = t & 1 ? BOARD_SIZE - 1 - x : x;
+                uint16_t ty = t & 2 ? BOARD_SIZE - 1 - y : y;
+                if (t & 4)
+                {
+                    uint16_t swap = tx;
+                    tx = ty;
+                    ty = swap;
+                }
+                tables[t][(y + 1) * (BOARD_SIZE + 2) + x + 1] = (ty + 1) * (BOARD_SIZE + 2) + tx + 1;
+            }
+        }
+    }
+    return tables;
+}
+
+constexpr std::array<std::array<uint16_t, NUM_POINTS>, NUM_SYMMETRIES> inverse_symmetry_tables()
+{
+    std::array<std::array<uint16_t, NUM_POINTS>, NUM_SYMMETRIES> tables = symmetry_tables();
+    std::array<std::array<uint16_t, NUM_POINTS>, NUM_SYMMETRIES> inverses{};
+    for (uint8_t t = 0; t < NUM_SYMMETRIES; t++)
+    {
+        for (uint16_t i = 0; i < NUM_POINTS; i++)
+        {
+            inverses[t][tables[t][i]] = i;
+        }
+    }
+    return inverses;
+}
+
+// for every point, the key of the point it turns into under each symmetry, kept together so updating
+// all 8 hashes reads one cache line
+constexpr std::array<std::array<uint64_t, NUM_SYMMETRIES>, NUM_POINTS> symmetric_zobrist_table(uint64_t seed)
+{
+    std::array<uint64_t, NUM_POINTS> keys = zobrist_table(seed);
+    std::array<std::array<uint16_t, NUM_POINTS>, NUM_SYMMETRIES> tables = symmetry_tables();
+    std::array<std::array<uint64_t, NUM_SYMMETRIES>, NUM_POINTS> table{};
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        for (uint8_t t = 0; t < NUM_SYMMETRIES; t++)
+        {
+            table[i][t] = keys[tables[t][i]];
+        }
+    }
+    return table;
+}
+
 struct nbrs
 {
     uint8_t edges;
@@ -31,27 +122,67 @@ struct nbrs
 
 class Board
 {
+    // reads the chain tables directly, the same way score() does
+    friend class Evaluator;
+    // and is_eye, for life and death
+    friend class LifeSolver;
 
 public:
     Board();
 
     bool make_play(uint16_t idx);
+    // replaces the position with the stones in stones (the border is ignored), building the chains, hashes and
+    // counts in one union-find pass instead of a make_play per stone; play_count decides the side to move and
+    // there is no ko history. false, leaving an empty board, if a chain would have no liberties
+    bool set_position(const std::array<pointType, NUM_POINTS> &stones, uint16_t play_count);
+    // plays moves with captures but without ko checks or chain upkeep, then rebuilds the chains once at the
+    // end, for loading recorded games; the ko hashes still end up those of each side's last move. returns
+    // how many were played, fewer than num_moves if one is on an occupied point or suicide
+    uint16_t play_sequence(const uint16_t *moves, uint16_t num_moves);
+    uint16_t get_legal_moves(std::array<uint16_t, NUM_POINTS> &moves) const;
     bool whose_turn() const;
     uint16_t get_play_count() const;
     void print_board() const;
+    // what print_board shows, for output that doesn't go straight to the console
+    std::string to_string() const;
     void check_for_errors() const;
+    // recounts every chain's size and liberties from scratch, O(N)
+    bool is_consistent() const;
+    playError get_play_error(uint16_t idx) const;
+    uint16_t get_stone_count(bool black) const;
+    // liberties of the chain the stone at idx belongs to
+    uint16_t get_chain_liberties(uint16_t idx) const;
     uint64_t get_hash() const;
+    // hash of the stones and the side to move, for books and transposition tables
+    uint64_t get_position_key() const;
+    // hash of the stones moved by the symmetry, symmetry 0 is get_hash()
+    uint64_t get_symmetric_hash(uint8_t symmetry) const;
+    // the smallest symmetric hash, the same for every rotation and reflection of the position; symmetry
+    // is set to the one that produced it, which takes points of this board to the stored orientation
+    uint64_t get_canonical_hash(uint8_t &symmetry) const;
+    // get_canonical_hash with the side to move, for tables holding one entry per equivalence class
+    uint64_t get_canonical_key(uint8_t &symmetry) const;
+    static uint16_t transform_point(uint8_t symmetry, uint16_t idx);
+    static uint16_t inverse_transform_point(uint8_t symmetry, uint16_t idx);
     pointType get_point(uint16_t idx) const;
+    static uint16_t coords_to_idx(uint16_t x, uint16_t y); // x is the column, y the row
+    static std::pair<int, int> idx_to_coords(uint16_t idx); // returns (row, column)
     std::array<int, 4> directions;
     std::array<int, 4> diagonals;
     int16_t score() const;
+    // black's area minus white's under Tromp-Taylor rules, without komi
+    int16_t area_score() const;
 
 protected:
     std::array<pointType, NUM_POINTS> board{};
 
-    uint64_t zobrist;
-    std::array<uint64_t, NUM_POINTS> zobrist_hashes_black{};
-    std::array<uint64_t, NUM_POINTS> zobrist_hashes_white{};
+    // zobrist[t] hashes the stones as symmetry t would place them, all 8 are kept up to date by set_point
+    std::array<uint64_t, NUM_SYMMETRIES> zobrist;
+    static constexpr std::array<std::array<uint64_t, NUM_SYMMETRIES>, NUM_POINTS> zobrist_hashes_black = symmetric_zobrist_table(ZOBRIST_SEED);
+    static constexpr std::array<std::array<uint64_t, NUM_SYMMETRIES>, NUM_POINTS> zobrist_hashes_white = symmetric_zobrist_table(ZOBRIST_SEED + 1);
+    static constexpr std::array<std::array<uint16_t, NUM_POINTS>, NUM_SYMMETRIES> symmetries = symmetry_tables();
+    static constexpr std::array<std::array<uint16_t, NUM_POINTS>, NUM_SYMMETRIES> inverse_symmetries = inverse_symmetry_tables();
+    static constexpr uint64_t zobrist_white_to_move = zobrist_table(ZOBRIST_SEED + 2)[0];
 
     std::array<uint16_t, NUM_POINTS> chain_roots{};
     // start of chain list
@@ -73,13 +204,12 @@ protected:
     void extend_chain(uint16_t idx, uint16_t adj_stone);
     void merge_chains(std::array<uint16_t, 4> chain_neighbors, uint16_t num_chains, uint16_t idx);
     void capture_chain(uint16_t chain_id);
+    // chain tables, hashes and counts from board alone
+    void rebuild_chains();
 
     nbrs get_nbrs(uint16_t idx) const;
     uint16_t get_liberties(uint16_t idx) const;
 
-    uint16_t coords_to_idx(uint16_t x, uint16_t y) const;
-    std::pair<int, int> idx_to_coords(uint16_t idx) const;
-
     uint16_t play_count;
     uint64_t black_ko_hash;
     uint64_t white_ko_hash;
@@ -3,6 +3,8 @@
 #include <cmath>
 
 #include "Board.h"
+#include "PerfCounters.h"
+#include "SearchStats.h"
 
 void Board::create_chain(uint16_t idx)
 {
@@ -48,6 +50,9 @@ void Board::extend_chain(uint16_t idx, uint16_t adj_stone)
 
 void Board::merge_chains(std::array<uint16_t, 4> neighbor_roots, uint16_t num_neighbors, uint16_t idx)
 {
+    PERF_REGION(REGION_MERGE_CHAINS);
+    STATS_INC(merges);
+    STATS_TIMER(merge_ns);
 #if DEBUG
     assert(num_neighbors > 1);
     for (uint16_t i = 0; i < num_neighbors; i++)
@@ -133,6 +138,10 @@ void Board::capture_chain(uint16_t chain_root)
 #if DEBUG
     assert(chain_liberties[chain_root] == 0);
 #endif
+    PERF_REGION(REGION_CAPTURE_CHAIN);
+    STATS_INC(captures);
+    STATS_ADD(captured_stones, chain_sizes[chain_root]);
+    STATS_TIMER(capture_ns);
     chain_sizes[chain_root] = 0;
 
     for (uint16_t i = 0; i < NUM_POINTS; i++)
@@ -149,6 +158,7 @@ void Board::capture_chain(uint16_t chain_root)
 
 void Board::update_chains(uint16_t idx)
 {
+    PERF_REGION(REGION_UPDATE_CHAINS);
     struct nbrs n = get_nbrs(idx);
 
     bool side = whose_turn();
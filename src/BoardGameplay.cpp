@@ -3,6 +3,7 @@
 #include <cmath>
 
 #include "Board.h"
+#include "SearchStats.h"
 
 bool Board::check_play(uint16_t idx) const
 {
@@ -20,8 +21,13 @@ bool Board::check_play(uint16_t idx) const
 
     // ko checking
 
+    STATS_INC(ko_checks);
     Board copy = *this;
-    copy.update_chains(idx);
+    {
+        // make_play counts the captures and merges again when it plays the move for real
+        STATS_PAUSE_CHAINS();
+        copy.update_chains(idx);
+    }
 
     if (color_to_move)
     {
@@ -39,6 +45,39 @@ bool Board::check_play(uint16_t idx) const
     }
 }
 
+uint16_t Board::get_legal_moves(std::array<uint16_t, NUM_POINTS> &moves) const
+{
+    // fills moves with every legal non-pass play and returns how many there are
+    uint16_t num_moves = 0;
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        if (check_play(i))
+        {
+            moves[num_moves] = i;
+            num_moves++;
+        }
+    }
+    return num_moves;
+}
+
+playError Board::get_play_error(uint16_t idx) const
+{
+    // why make_play would reject idx, only meant for reporting so it redoes the checks
+    if (idx == PASS)
+    {
+        return PLAY_OK;
+    }
+    if (board[idx] != pointType::EMPTY)
+    {
+        return PLAY_OCCUPIED;
+    }
+    if (is_suicide(idx))
+    {
+        return PLAY_SUICIDE;
+    }
+    return check_play(idx) ? PLAY_OK : PLAY_KO;
+}
+
 bool Board::is_suicide(uint16_t idx) const
 {
     // check if move is suicide
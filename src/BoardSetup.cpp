@@ -0,0 +1,211 @@
+#include "Board.h"
+
+#include <algorithm>
+
+// follows parents to the root, halving the path on the way; parents are never above their children
+static uint16_t find_root(std::array<uint16_t, NUM_POINTS> &parents, uint16_t idx)
+{
+    while (parents[idx] != idx)
+    {
+        parents[idx] = parents[parents[idx]];
+        idx = parents[idx];
+    }
+    return idx;
+}
+
+void Board::rebuild_chains()
+{
+    chain_roots.fill(0);
+    chain_liberties.fill(0);
+    chain_sizes.fill(0);
+    zobrist.fill(0);
+    black_count = 0;
+    white_count = 0;
+    empty_count = 0;
+
+    // scanning in index order, each stone only has to be joined to its north and west neighbours
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        pointType point = board[i];
+        if (point == pointType::EMPTY)
+        {
+            empty_count++;
+            continue;
+        }
+        if (point == pointType::BLANK)
+        {
+            continue;
+        }
+        bool black = point == pointType::BLACK;
+        black_count += black;
+        white_count += !black;
+        for (uint8_t t = 0; t < NUM_SYMMETRIES; t++)
+        {
+            zobrist[t] ^= black ? zobrist_hashes_black[i][t] : zobrist_hashes_white[i][t];
+        }
+
+        chain_roots[i] = i;
+        for (uint16_t d = 0; d < 2; d++)
+        {
+            uint16_t neighbor = i + directions[d];
+            if (board[neighbor] != point)
+            {
+                continue;
+            }
+            uint16_t root = find_root(chain_roots, neighbor);
+            uint16_t own_root = find_root(chain_roots, i);
+            // the lower index becomes the root, which keeps every parent below its child
+            chain_roots[std::max(root, own_root)] = std::min(root, own_root);
+        }
+    }
+
+    // parents come first, so by the time a stone is reached its parent already points at the root
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        if (chain_roots[i] != 0)
+        {
+            chain_roots[i] = chain_roots[chain_roots[i]];
+            chain_sizes[chain_roots[i]]++;
+        }
+    }
+
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        if (board[i] != pointType::EMPTY)
+        {
+            continue;
+        }
+        // an empty point is one liberty of each different chain next to it
+        std::array<uint16_t, 4> counted{};
+        for (uint16_t d = 0; d < 4; d++)
+        {
+            uint16_t root = chain_roots[i + directions[d]];
+            if (root != 0 && root != counted[0] && root != counted[1] && root != counted[2])
+            {
+                counted[d] = root;
+                chain_liberties[root]++;
+            }
+        }
+    }
+}
+
+bool Board::set_position(const std::array<pointType, NUM_POINTS> &stones, uint16_t play_count)
+{
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        if (board[i] != pointType::BLANK)
+        {
+            board[i] = stones[i] == pointType::BLACK || stones[i] == pointType::WHITE ? stones[i] : pointType::EMPTY;
+        }
+    }
+    rebuild_chains();
+    this->play_count = play_count;
+    black_ko_hash = 0;
+    white_ko_hash = 0;
+
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        if (chain_sizes[i] != 0 && chain_liberties[i] == 0)
+        {
+            *this = Board();
+            return false;
+        }
+    }
+#if DEBUG
+    check_for_errors();
+#endif
+    return true;
+}
+
+uint16_t Board::play_sequence(const uint16_t *moves, uint16_t num_moves)
+{
+    // only the plain hash is kept up as we go, for the ko hashes
+    uint64_t hash = zobrist[0];
+    std::array<uint16_t, NUM_POINTS> marks{};
+    uint16_t mark = 0;
+    std::array<uint16_t, NUM_POINTS> chain;
+
+    // collects the chain at idx into chain and returns its size, or 0 as soon as it turns out to have a liberty
+    auto flood_if_dead = [&](uint16_t idx)
+    {
+        if (++mark == 0)
+        {
+            marks.fill(0);
+            mark = 1;
+        }
+        pointType colour = board[idx];
+        marks[idx] = mark;
+        chain[0] = idx;
+        uint16_t size = 1;
+        for (uint16_t next = 0; next < size; next++)
+        {
+            for (uint16_t d = 0; d < 4; d++)
+            {
+                uint16_t neighbor = chain[next] + directions[d];
+                if (board[neighbor] == pointType::EMPTY)
+                {
+                    return uint16_t(0);
+                }
+                if (board[neighbor] == colour && marks[neighbor] != mark)
+                {
+                    marks[neighbor] = mark;
+                    chain[size++] = neighbor;
+                }
+            }
+        }
+        return size;
+    };
+
+    uint16_t played = 0;
+    for (; played < num_moves; played++)
+    {
+        uint16_t idx = moves[played];
+        if (idx == PASS)
+        {
+            play_count++;
+            continue;
+        }
+        if (board[idx] != pointType::EMPTY)
+        {
+            break;
+        }
+        bool black = whose_turn();
+        pointType colour = black ? pointType::BLACK : pointType::WHITE;
+        pointType opponent = black ? pointType::WHITE : pointType::BLACK;
+        board[idx] = colour;
+        hash ^= black ? zobrist_hashes_black[idx][0] : zobrist_hashes_white[idx][0];
+
+        bool captured = false;
+        for (uint16_t d = 0; d < 4; d++)
+        {
+            uint16_t neighbor = idx + directions[d];
+            if (board[neighbor] != opponent)
+            {
+                continue;
+            }
+            uint16_t size = flood_if_dead(neighbor);
+            for (uint16_t i = 0; i < size; i++)
+            {
+                board[chain[i]] = pointType::EMPTY;
+                hash ^= black ? zobrist_hashes_white[chain[i]][0] : zobrist_hashes_black[chain[i]][0];
+            }
+            captured |= size != 0;
+        }
+        // a capture always leaves the new stone a liberty
+        if (!captured && flood_if_dead(idx) != 0)
+        {
+            board[idx] = pointType::EMPTY;
+            hash ^= black ? zobrist_hashes_black[idx][0] : zobrist_hashes_white[idx][0];
+            break;
+        }
+
+        play_count++;
+        (black ? black_ko_hash : white_ko_hash) = hash;
+    }
+
+    rebuild_chains();
+#if DEBUG
+    check_for_errors();
+#endif
+    return played;
+}
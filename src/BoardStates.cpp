@@ -4,8 +4,9 @@
 #include <cmath>
 
 #include "Board.h"
+#include "PerfCounters.h"
 
-uint16_t Board::coords_to_idx(uint16_t x, uint16_t y) const
+uint16_t Board::coords_to_idx(uint16_t x, uint16_t y)
 {
 #if DEBUG
     assert(x >= 0 && x < BOARD_SIZE);
@@ -13,10 +14,10 @@ uint16_t Board::coords_to_idx(uint16_t x, uint16_t y) const
 #endif
     return (BOARD_SIZE + 2) * (y + 1) + x + 1;
 }
-std::pair<int, int> Board::idx_to_coords(uint16_t idx) const
+std::pair<int, int> Board::idx_to_coords(uint16_t idx)
 {
 #if DEBUG
-    assert(idx >= 0 && (unsigned int)idx < board.size());
+    assert(idx < NUM_POINTS);
 #endif
     return std::pair<int, int>(idx / (BOARD_SIZE + 2) - 1, idx % (BOARD_SIZE + 2) - 1);
 }
@@ -72,6 +73,7 @@ void Board::check_position(uint16_t idx) const
 
 int16_t Board::score() const
 {
+    PERF_REGION(REGION_SCORE);
     int black_liberties = 0;
     int white_liberties = 0;
 
@@ -140,6 +142,57 @@ int16_t Board::score() const
     return -komi + black_liberties - white_liberties + (black_chain_score >> 3) - (white_chain_score >> 3) + black_eyes * 3 - white_eyes * 3;
 }
 
+int16_t Board::area_score() const
+{
+    // Tromp-Taylor: stones plus empty regions that only touch one colour, no komi
+    int16_t area = 0;
+    std::array<bool, NUM_POINTS> visited{};
+    std::array<uint16_t, NUM_POINTS> stack;
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        if (board[i] == pointType::BLACK)
+        {
+            area++;
+        }
+        else if (board[i] == pointType::WHITE)
+        {
+            area--;
+        }
+        if (board[i] != pointType::EMPTY || visited[i])
+        {
+            continue;
+        }
+
+        uint16_t region_size = 0;
+        bool reaches_black = false;
+        bool reaches_white = false;
+        uint16_t stack_size = 0;
+        stack[stack_size++] = i;
+        visited[i] = true;
+        while (stack_size)
+        {
+            uint16_t point = stack[--stack_size];
+            region_size++;
+            for (int d : directions)
+            {
+                uint16_t neighbor = point + d;
+                reaches_black |= board[neighbor] == pointType::BLACK;
+                reaches_white |= board[neighbor] == pointType::WHITE;
+                if (board[neighbor] == pointType::EMPTY && !visited[neighbor])
+                {
+                    visited[neighbor] = true;
+                    stack[stack_size++] = neighbor;
+                }
+            }
+        }
+        if (reaches_black != reaches_white)
+        {
+            area += reaches_black ? region_size : -region_size;
+        }
+    }
+    return area;
+}
+
 pointType Board::get_point(uint16_t idx) const
 {
     return board[idx];
@@ -155,14 +208,13 @@ void Board::set_point(uint16_t idx, pointType value)
     assert(!(current_state == WHITE && value == BLACK));
 #endif
 
-    // xor to erase stone
-    zobrist ^= (zobrist_hashes_black[idx]) * (current_state == pointType::BLACK && value == pointType::EMPTY);
-
-    zobrist ^= (zobrist_hashes_white[idx]) * (current_state == pointType::WHITE && value == pointType::EMPTY);
-
-    // xor to add stone
-    zobrist ^= (zobrist_hashes_black[idx]) * (value == pointType::BLACK);
-    zobrist ^= (zobrist_hashes_white[idx]) * (value == pointType::WHITE);
+    // a stone is only ever added to or erased from an empty point, either way its key is xored in once
+    uint64_t toggle_black = (current_state == pointType::BLACK) != (value == pointType::BLACK);
+    uint64_t toggle_white = (current_state == pointType::WHITE) != (value == pointType::WHITE);
+    for (uint8_t t = 0; t < NUM_SYMMETRIES; t++)
+    {
+        zobrist[t] ^= zobrist_hashes_black[idx][t] * toggle_black ^ zobrist_hashes_white[idx][t] * toggle_white;
+    }
 
     board[idx] = value;
 
@@ -0,0 +1,117 @@
+#ifndef CORPUS_SCAN_H
+#define CORPUS_SCAN_H
+/* Parallel pipeline over a directory of SGF files. One thread enumerates files into a bounded queue,
+   a pool of workers parses them and hands each game to a visitor together with that worker's own
+   statistics, and the per-worker statistics are merged with Stats::add at the end. */
+#include "SGFFile.h"
+#include "WorkQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CorpusProgress
+{
+    std::atomic<uint64_t> files{0};
+    std::atomic<uint64_t> moves{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint16_t> workers_done{0};
+};
+
+static constexpr auto CORPUS_QUEUE_SIZE = 4096;
+
+inline uint16_t default_thread_count()
+{
+    uint16_t threads = std::thread::hardware_concurrency();
+    return threads ? threads : 1;
+}
+
+inline void print_corpus_progress(const CorpusProgress &progress, double seconds, bool final)
+{
+    uint64_t files = progress.files;
+    uint64_t moves = progress.moves;
+    fprintf(stderr, "\r%lu files (%lu failed), %lu moves in %.1fs: %.0f files/s, %.0f moves/s%s",
+            (unsigned long)files, (unsigned long)progress.failed.load(), (unsigned long)moves,
+            seconds, seconds > 0 ? files / seconds : 0.0, seconds > 0 ? moves / seconds : 0.0, final ? "\n" : "");
+}
+
+// visit(const SGFFile &, Stats &) runs on the worker threads, Stats needs a default constructor and add(const Stats &)
+template <typename Stats, typename Visit>
+Stats scan_corpus(const std::string &root, uint16_t num_threads, Visit visit, bool report_progress = true)
+{
+    num_threads = num_threads ? num_threads : default_thread_count();
+    WorkQueue<std::string> paths(CORPUS_QUEUE_SIZE);
+    CorpusProgress progress;
+    std::vector<Stats> thread_stats(num_threads);
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread enumerator([&]()
+                           {
+        std::error_code error;
+        for (auto it = std::filesystem::recursive_directory_iterator(root, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+        {
+            if (it->path().extension() == ".sgf" && !paths.push(it->path().string()))
+            {
+                break;
+            }
+        }
+        if (error)
+        {
+            std::cout << "Failed to read directory " << root << ": " << error.message() << '\n';
+        }
+        paths.close(); });
+
+    std::vector<std::thread> workers;
+    for (uint16_t t = 0; t < num_threads; t++)
+    {
+        workers.emplace_back([&, t]()
+                             {
+            std::string path;
+            while (paths.pop(path))
+            {
+                SGFFile file(path);
+                if (!file.is_valid())
+                {
+                    progress.failed++;
+                    continue;
+                }
+                visit(file, thread_stats[t]);
+                progress.files++;
+                progress.moves += file.get_moves().size();
+            }
+            progress.workers_done++; });
+    }
+
+    auto elapsed = [&]()
+    { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+    while (progress.workers_done < num_threads)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (report_progress)
+        {
+            print_corpus_progress(progress, elapsed(), false);
+        }
+    }
+
+    enumerator.join();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    if (report_progress)
+    {
+        print_corpus_progress(progress, elapsed(), true);
+    }
+
+    Stats total = Stats();
+    for (const Stats &stats : thread_stats)
+    {
+        total.add(stats);
+    }
+    return total;
+}
+
+#endif
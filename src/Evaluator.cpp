@@ -0,0 +1,207 @@
+#include "Evaluator.h"
+#include "MoveOrdering.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+// 8 floats, one AVX register or two SSE ones depending on the target
+typedef float float8 __attribute__((vector_size(32)));
+
+const std::array<const char *, NUM_USED_FEATURES> feature_names = {
+    "bias", "to_move", "stones", "liberties", "short_stones", "atari_chains", "two_liberty_chains",
+    "three_liberty_chains", "free_chains", "atari_stones", "chain_size_squared", "eyes", "influence"};
+
+EvalFeatures default_weights()
+{
+    // the constants Board::score uses
+    EvalFeatures weights{};
+    weights[FEATURE_BIAS] = -komi;
+    weights[FEATURE_LIBERTIES] = 1;
+    weights[FEATURE_SHORT_STONES] = -1;
+    weights[FEATURE_CHAIN_SIZE_SQUARED] = 1.0f / 8;
+    weights[FEATURE_EYES] = 3;
+    return weights;
+}
+
+Evaluator::Evaluator() : weights(default_weights())
+{
+}
+
+bool Evaluator::load(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        return false;
+    }
+    // features the file leaves out keep their default weight
+    EvalFeatures loaded = default_weights();
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream words(line);
+        std::string name;
+        float weight;
+        if (!(words >> name) || name[0] == '#')
+        {
+            continue;
+        }
+        uint16_t feature = 0;
+        while (feature < NUM_USED_FEATURES && name != feature_names[feature])
+        {
+            feature++;
+        }
+        if (feature == NUM_USED_FEATURES || !(words >> weight))
+        {
+            std::cout << "Rejected evaluation weights " << path << " (bad line: " << line << ")" << '\n';
+            return false;
+        }
+        loaded[feature] = weight;
+    }
+    weights = loaded;
+    return true;
+}
+
+bool Evaluator::save(const std::string &path) const
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        std::cout << "Failed to open file " << path << '\n';
+        return false;
+    }
+    out << "# evaluation weights, black's count minus white's times the weight is added to the score\n";
+    for (uint16_t feature = 0; feature < NUM_USED_FEATURES; feature++)
+    {
+        out << feature_names[feature] << ' ' << weights[feature] << '\n';
+    }
+    return bool(out);
+}
+
+void Evaluator::set_weights(const EvalFeatures &new_weights)
+{
+    weights = new_weights;
+}
+
+const EvalFeatures &Evaluator::get_weights() const
+{
+    return weights;
+}
+
+uint64_t Evaluator::fingerprint() const
+{
+    // fnv-1a over the weights' bytes
+    uint64_t hash = 0xcbf29ce484222325;
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(weights.data());
+    for (size_t i = 0; i < sizeof(weights); i++)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001b3;
+    }
+    return hash;
+}
+
+void Evaluator::extract_features(const Board &b, EvalFeatures &features)
+{
+    features.fill(0);
+    features[FEATURE_BIAS] = 1;
+    features[FEATURE_TO_MOVE] = b.whose_turn() ? 1 : -1;
+    uint16_t play_count = b.get_play_count();
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        pointType point = b.board[i];
+        if (point == pointType::EMPTY)
+        {
+            switch (b.is_eye(i))
+            {
+            case BLACK:
+                features[FEATURE_EYES]++;
+                break;
+            case WHITE:
+                features[FEATURE_EYES]--;
+                break;
+            }
+            continue;
+        }
+        if (point == pointType::BLANK)
+        {
+            continue;
+        }
+
+        float sign = point == pointType::BLACK ? 1 : -1;
+        features[FEATURE_STONES] += sign;
+        features[FEATURE_INFLUENCE] += sign * point_weight(i, play_count);
+        // chain totals are kept on the root only
+        uint16_t liberties = b.chain_liberties[i];
+        if (liberties == 0)
+        {
+            continue;
+        }
+        uint16_t size = b.chain_sizes[i];
+        features[FEATURE_LIBERTIES] += sign * liberties;
+        features[FEATURE_SHORT_STONES] += liberties < 3 ? sign * size : 0;
+        features[FEATURE_ATARI_STONES] += liberties == 1 ? sign * size : 0;
+        features[FEATURE_CHAIN_SIZE_SQUARED] += sign * size * size;
+        // the buckets are consecutive features
+        features[FEATURE_ATARI_CHAINS + std::min<uint16_t>(liberties, 4) - 1] += sign;
+    }
+}
+
+float Evaluator::dot(const EvalFeatures &features, const EvalFeatures &weights)
+{
+    float8 sum = {};
+    for (uint16_t i = 0; i < NUM_FEATURES; i += 8)
+    {
+        float8 f;
+        float8 w;
+        memcpy(&f, features.data() + i, sizeof(f));
+        memcpy(&w, weights.data() + i, sizeof(w));
+        sum += f * w;
+    }
+    return (sum[0] + sum[4]) + (sum[1] + sum[5]) + (sum[2] + sum[6]) + (sum[3] + sum[7]);
+}
+
+int16_t Evaluator::evaluate(const Board &b) const
+{
+    alignas(32) EvalFeatures features;
+    extract_features(b, features);
+    // well inside the search's window, whatever the weights
+    float score = std::fmax(-30000.0f, std::fmin(30000.0f, dot(features, weights)));
+    return int16_t(std::lround(score));
+}
+
+void TuningSet::add_game(const GameRecord &record, uint16_t skip_plies)
+{
+    if (record.has_setup() || record.winner == 0)
+    {
+        return;
+    }
+    bool held_out = std::hash<std::string>()(record.source) % 10 == 0;
+    std::vector<EvalFeatures> &game_features = held_out ? held_out_features : features;
+    std::vector<int8_t> &game_results = held_out ? held_out_results : results;
+    Board b;
+    for (uint16_t i = 0; i < record.moves.size(); i++)
+    {
+        if (i >= skip_plies)
+        {
+            game_features.emplace_back();
+            Evaluator::extract_features(b, game_features.back());
+            game_results.push_back(record.winner);
+        }
+        if (!b.make_play(record.moves[i]))
+        {
+            break;
+        }
+    }
+}
+
+void TuningSet::add(const TuningSet &other)
+{
+    features.insert(features.end(), other.features.begin(), other.features.end());
+    results.insert(results.end(), other.results.begin(), other.results.end());
+    held_out_features.insert(held_out_features.end(), other.held_out_features.begin(), other.held_out_features.end());
+    held_out_results.insert(held_out_results.end(), other.held_out_results.begin(), other.held_out_results.end());
+}
@@ -0,0 +1,79 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+/* Linear static evaluation. The board is reduced to a fixed width vector of features, each one black's
+   count minus white's, and the score is its dot product with a weight vector. The default weights
+   reproduce Board::score; tuned ones are read from a text file of "name weight" lines written by the
+   tune_eval tool, so trying new weights needs no rebuild. */
+#include "Board.h"
+#include "GameRecord.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum evalFeature
+{
+    FEATURE_BIAS = 0,          // always 1, komi and the value of having played first
+    FEATURE_TO_MOVE,           // 1 with black to move, -1 with white
+    FEATURE_STONES,
+    FEATURE_LIBERTIES,         // liberties of every chain added up
+    FEATURE_SHORT_STONES,      // stones in chains with fewer than 3 liberties
+    FEATURE_ATARI_CHAINS,      // liberty buckets, chains with 1, 2, 3 and 4 or more liberties
+    FEATURE_TWO_LIBERTY_CHAINS,
+    FEATURE_THREE_LIBERTY_CHAINS,
+    FEATURE_FREE_CHAINS,
+    FEATURE_ATARI_STONES,
+    FEATURE_CHAIN_SIZE_SQUARED,
+    FEATURE_EYES,
+    FEATURE_INFLUENCE,         // point_weights of the points each side has stones on
+    NUM_USED_FEATURES
+};
+
+// padded to whole SIMD registers, the padding features are always 0
+static constexpr uint16_t NUM_FEATURES = 16;
+static_assert(NUM_USED_FEATURES <= NUM_FEATURES);
+
+using EvalFeatures = std::array<float, NUM_FEATURES>;
+
+extern const std::array<const char *, NUM_USED_FEATURES> feature_names;
+
+EvalFeatures default_weights();
+
+class Evaluator
+{
+public:
+    Evaluator();
+
+    bool load(const std::string &path);
+    bool save(const std::string &path) const;
+    void set_weights(const EvalFeatures &new_weights);
+    const EvalFeatures &get_weights() const;
+    // changes with any weight, for tables that keep scores across runs
+    uint64_t fingerprint() const;
+
+    static void extract_features(const Board &b, EvalFeatures &features);
+    static float dot(const EvalFeatures &features, const EvalFeatures &weights);
+    // black's advantage in points, like Board::score
+    int16_t evaluate(const Board &b) const;
+
+protected:
+    alignas(32) EvalFeatures weights;
+};
+
+// per thread samples for scan_records, positions from games with a known winner
+struct TuningSet
+{
+    std::vector<EvalFeatures> features;
+    std::vector<int8_t> results; // winner of the game, 1 black and -1 white
+    std::vector<EvalFeatures> held_out_features; // about one game in ten, for checking the fit
+    std::vector<int8_t> held_out_results;
+
+    // every position from ply skip_plies on, games with setup stones are skipped
+    void add_game(const GameRecord &record, uint16_t skip_plies);
+    void add(const TuningSet &other);
+};
+
+const std::string path_to_weights = "eval_weights.txt";
+
+#endif
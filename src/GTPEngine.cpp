@@ -0,0 +1,377 @@
+#include "GTPEngine.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+static constexpr uint8_t MAX_TIMED_DEPTH = 32;
+static constexpr const char *GTP_COLUMNS = "ABCDEFGHJKLMNOPQRSTUVWXYZ";
+
+static const std::array<const char *, 16> gtp_commands = {"protocol_version", "name", "version", "known_command", "list_commands", "quit", "boardsize", "clear_board", "komi", "play", "genmove", "undo", "time_settings", "time_left", "final_score", "showboard"};
+
+bool parse_gtp_colour(const std::string &text, bool &black)
+{
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower == "b" || lower == "black")
+    {
+        black = true;
+        return true;
+    }
+    if (lower == "w" || lower == "white")
+    {
+        black = false;
+        return true;
+    }
+    return false;
+}
+
+bool parse_gtp_vertex(const std::string &text, uint16_t &idx)
+{
+    std::string upper = text;
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    if (upper == "PASS")
+    {
+        idx = PASS;
+        return true;
+    }
+    if (upper.size() < 2 || upper[0] == 'I')
+    {
+        return false;
+    }
+    const char *column = std::find(GTP_COLUMNS, GTP_COLUMNS + BOARD_SIZE, upper[0]);
+    int row = std::atoi(upper.c_str() + 1);
+    if (column == GTP_COLUMNS + BOARD_SIZE || row < 1 || row > BOARD_SIZE)
+    {
+        return false;
+    }
+    // gtp counts rows from the bottom, the board from the top
+    idx = Board::coords_to_idx(column - GTP_COLUMNS, BOARD_SIZE - row);
+    return true;
+}
+
+std::string gtp_vertex(uint16_t idx)
+{
+    if (idx == PASS)
+    {
+        return "pass";
+    }
+    if (idx == RESIGN)
+    {
+        return "resign";
+    }
+    std::pair<int, int> coords = Board::idx_to_coords(idx);
+    return GTP_COLUMNS[coords.second] + std::to_string(BOARD_SIZE - coords.first);
+}
+
+GTPEngine::GTPEngine(size_t hash_megabytes, uint8_t depth) : tt(std::make_shared<TranspositionTable>(hash_megabytes)), depth(depth)
+{
+    agent.set_transposition_table(tt);
+}
+
+void GTPEngine::set_book(std::shared_ptr<const OpeningBook> book)
+{
+    agent.set_book(book);
+}
+
+void GTPEngine::set_patterns(std::shared_ptr<const PatternTable> patterns)
+{
+    agent.set_patterns(patterns);
+}
+
+void GTPEngine::set_evaluator(std::shared_ptr<const Evaluator> evaluator)
+{
+    agent.set_evaluator(evaluator);
+}
+
+void GTPEngine::set_transposition_table(std::shared_ptr<TranspositionTable> tt)
+{
+    this->tt = tt;
+    agent.set_transposition_table(tt);
+}
+
+bool GTPEngine::is_timed() const
+{
+    // byo-yomi time without stones is how gtp says there is no limit
+    if (byo_yomi_time > 0 && byo_yomi_stones == 0)
+    {
+        return false;
+    }
+    return main_time > 0 || byo_yomi_time > 0;
+}
+
+double GTPEngine::time_for_move(bool black) const
+{
+    const GTPClock &clock = clocks[black];
+    double budget;
+    if (clock.stones > 0)
+    {
+        budget = clock.seconds / clock.stones;
+    }
+    else
+    {
+        // assume we play about half the empty points that are left, the last ones are quick
+        double stones = board.get_stone_count(true) + board.get_stone_count(false);
+        double moves_left = std::max((BOARD_SIZE * BOARD_SIZE - stones) / 2, 10.0);
+        budget = clock.seconds / moves_left;
+        if (byo_yomi_stones > 0)
+        {
+            budget += byo_yomi_time / byo_yomi_stones;
+        }
+    }
+    // leave room for the overshoot of the last iteration and the time it takes the reply to arrive
+    return std::max(budget * 0.8 - 0.05, 0.01);
+}
+
+void GTPEngine::reset_clocks()
+{
+    GTPClock start = main_time > 0 ? GTPClock{main_time, 0} : GTPClock{byo_yomi_time, byo_yomi_stones};
+    clocks[0] = start;
+    clocks[1] = start;
+}
+
+void GTPEngine::spend_time(bool black, double seconds)
+{
+    // bookkeeping for controllers that never send time_left
+    GTPClock &clock = clocks[black];
+    clock.seconds -= seconds;
+    if (clock.stones == 0)
+    {
+        // still in main time, once it runs out the first byo-yomi period starts
+        if (clock.seconds <= 0)
+        {
+            clock = GTPClock{byo_yomi_time, byo_yomi_stones};
+        }
+        return;
+    }
+    if (--clock.stones == 0)
+    {
+        clock = GTPClock{byo_yomi_time, byo_yomi_stones};
+    }
+}
+
+void GTPEngine::set_turn(bool black)
+{
+    if (board.whose_turn() != black)
+    {
+        board.make_play(PASS);
+    }
+}
+
+bool GTPEngine::execute(const std::string &command, std::vector<std::string> &args, std::string &response, bool &quit)
+{
+    response.clear();
+    if (command == "protocol_version")
+    {
+        response = "2";
+    }
+    else if (command == "name")
+    {
+        response = "stella";
+    }
+    else if (command == "version")
+    {
+        response = "0.1";
+    }
+    else if (command == "known_command")
+    {
+        bool known = !args.empty() && std::find(gtp_commands.begin(), gtp_commands.end(), args[0]) != gtp_commands.end();
+        response = known ? "true" : "false";
+    }
+    else if (command == "list_commands")
+    {
+        for (const char *name : gtp_commands)
+        {
+            response += (response.empty() ? "" : "\n") + std::string(name);
+        }
+    }
+    else if (command == "quit")
+    {
+        quit = true;
+    }
+    else if (command == "boardsize")
+    {
+        // the board size is fixed when the engine is compiled
+        if (args.empty() || std::atoi(args[0].c_str()) != BOARD_SIZE)
+        {
+            response = "unacceptable size";
+            return false;
+        }
+        board = Board();
+        history.clear();
+    }
+    else if (command == "clear_board")
+    {
+        board = Board();
+        history.clear();
+        reset_clocks();
+    }
+    else if (command == "komi")
+    {
+        if (args.empty())
+        {
+            response = "syntax error";
+            return false;
+        }
+        game_komi = std::atof(args[0].c_str());
+    }
+    else if (command == "play")
+    {
+        bool black;
+        uint16_t idx;
+        if (args.size() < 2 || !parse_gtp_colour(args[0], black) || !parse_gtp_vertex(args[1], idx))
+        {
+            response = "syntax error";
+            return false;
+        }
+        Board before = board;
+        set_turn(black);
+        if (!board.make_play(idx))
+        {
+            board = before;
+            response = "illegal move";
+            return false;
+        }
+        history.push_back(before);
+    }
+    else if (command == "genmove")
+    {
+        bool black;
+        if (args.empty() || !parse_gtp_colour(args[0], black))
+        {
+            response = "syntax error";
+            return false;
+        }
+        auto start = std::chrono::steady_clock::now();
+        history.push_back(board);
+        set_turn(black);
+        std::pair<uint16_t, int16_t> best = is_timed() ? agent.search(board, MAX_TIMED_DEPTH, time_for_move(black))
+                                                       : agent.search(board, depth, 0);
+        if (!board.make_play(best.first))
+        {
+            board.make_play(PASS);
+            best.first = PASS;
+        }
+        if (is_timed())
+        {
+            spend_time(black, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        response = gtp_vertex(best.first);
+    }
+    else if (command == "undo")
+    {
+        if (history.empty())
+        {
+            response = "cannot undo";
+            return false;
+        }
+        board = history.back();
+        history.pop_back();
+    }
+    else if (command == "time_settings")
+    {
+        if (args.size() < 3)
+        {
+            response = "syntax error";
+            return false;
+        }
+        main_time = std::atof(args[0].c_str());
+        byo_yomi_time = std::atof(args[1].c_str());
+        byo_yomi_stones = std::atoi(args[2].c_str());
+        reset_clocks();
+    }
+    else if (command == "time_left")
+    {
+        bool black;
+        if (args.size() < 3 || !parse_gtp_colour(args[0], black))
+        {
+            response = "syntax error";
+            return false;
+        }
+        clocks[black] = GTPClock{std::atof(args[1].c_str()), std::atoi(args[2].c_str())};
+    }
+    else if (command == "final_score")
+    {
+        float margin = board.area_score() - game_komi;
+        if (margin == 0)
+        {
+            response = "0";
+        }
+        else
+        {
+            char text[32];
+            snprintf(text, sizeof(text), "%c+%g", margin > 0 ? 'B' : 'W', std::fabs(margin));
+            response = text;
+        }
+    }
+    else if (command == "showboard")
+    {
+        static const std::array<const char *, 4> symbols = {"# ", ". ", "X ", "O "};
+        for (uint16_t row = 0; row < BOARD_SIZE; row++)
+        {
+            response += "\n" + std::to_string(BOARD_SIZE - row) + (BOARD_SIZE - row < 10 ? "  " : " ");
+            for (uint16_t column = 0; column < BOARD_SIZE; column++)
+            {
+                response += symbols[board.get_point(Board::coords_to_idx(column, row))];
+            }
+        }
+    }
+    else
+    {
+        response = "unknown command";
+        return false;
+    }
+    return true;
+}
+
+void GTPEngine::run(std::istream &in, std::ostream &out)
+{
+    std::string line;
+    bool quit = false;
+    while (!quit && std::getline(in, line))
+    {
+        // drop comments and control characters, tabs count as spaces
+        line = line.substr(0, line.find('#'));
+        std::string cleaned;
+        for (char c : line)
+        {
+            if (c == '\t')
+            {
+                cleaned += ' ';
+            }
+            else if (c >= 32 && c != 127)
+            {
+                cleaned += c;
+            }
+        }
+
+        std::istringstream words(cleaned);
+        std::string id;
+        std::string command;
+        if (!(words >> command))
+        {
+            continue;
+        }
+        if (std::all_of(command.begin(), command.end(), ::isdigit))
+        {
+            id = command;
+            if (!(words >> command))
+            {
+                continue;
+            }
+        }
+        std::vector<std::string> args;
+        for (std::string arg; words >> arg;)
+        {
+            args.push_back(arg);
+        }
+
+        std::string response;
+        bool ok = execute(command, args, response, quit);
+        out << (ok ? '=' : '?') << id << (response.empty() ? "" : " ") << response << "\n\n";
+        out.flush();
+    }
+}
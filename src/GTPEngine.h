@@ -0,0 +1,61 @@
+#ifndef GTP_ENGINE_H
+#define GTP_ENGINE_H
+/* Go Text Protocol front end. One engine lives for the whole session, so the board, the undo history
+   and the agent with its transposition table carry over from one command to the next and every
+   genmove starts from what the previous searches found. */
+#include "Agent.h"
+#include "Board.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct GTPClock
+{
+    double seconds = 0; // left in the current period
+    int stones = 0;     // stones to play in this byo-yomi period, 0 while in main time
+};
+
+class GTPEngine
+{
+public:
+    GTPEngine(size_t hash_megabytes = 64, uint8_t depth = 3);
+
+    void set_book(std::shared_ptr<const OpeningBook> book);
+    void set_patterns(std::shared_ptr<const PatternTable> patterns);
+    void set_evaluator(std::shared_ptr<const Evaluator> evaluator);
+    // replaces the table the engine made for itself, e.g. with one backed by a file
+    void set_transposition_table(std::shared_ptr<TranspositionTable> tt);
+
+    // reads commands until quit or end of input
+    void run(std::istream &in, std::ostream &out);
+    // handles one command line, returns false if it was an error, quit is set by the quit command
+    bool execute(const std::string &command, std::vector<std::string> &args, std::string &response, bool &quit);
+
+protected:
+    Board board;
+    std::vector<Board> history; // positions before each play or genmove, for undo
+    Agent agent;
+    std::shared_ptr<TranspositionTable> tt;
+    uint8_t depth; // search depth when there are no time controls
+    float game_komi = komi;
+
+    double main_time = 0;
+    double byo_yomi_time = 0;
+    int byo_yomi_stones = 0;
+    GTPClock clocks[2]; // indexed by whose_turn(), so [1] is black
+
+    bool is_timed() const;
+    double time_for_move(bool black) const;
+    void spend_time(bool black, double seconds);
+    void reset_clocks();
+    // passes for the side to move if colour isn't on turn, the board takes turns by move count
+    void set_turn(bool black);
+};
+
+bool parse_gtp_colour(const std::string &text, bool &black);
+bool parse_gtp_vertex(const std::string &text, uint16_t &idx);
+std::string gtp_vertex(uint16_t idx);
+
+#endif
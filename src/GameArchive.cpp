@@ -0,0 +1,292 @@
+#include "GameArchive.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::string archive_index_path(const std::string &path)
+{
+    return path + ".idx";
+}
+
+static const uint8_t *map_file(const std::string &path, size_t &length)
+{
+    length = 0;
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        return nullptr;
+    }
+    const uint8_t *mapped = nullptr;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            mapped = static_cast<const uint8_t *>(mapping);
+            length = st.st_size;
+        }
+    }
+    close(fd);
+    return mapped;
+}
+
+uint16_t GameView::point(uint32_t i) const
+{
+    if (header->flags & GAME_WIDE_POINTS)
+    {
+        uint16_t value;
+        memcpy(&value, points + 2 * i, sizeof(value));
+        return value;
+    }
+    return points[i] == 0xFF ? ARCHIVE_PASS : points[i];
+}
+
+uint16_t GameView::num_moves() const
+{
+    return header->num_moves;
+}
+
+uint16_t GameView::move(uint32_t i) const
+{
+    return point(header->num_black_setup + header->num_white_setup + i);
+}
+
+bool GameView::move_is_black(uint32_t i) const
+{
+    return ((i & 1) == 0) == bool(header->flags & GAME_BLACK_FIRST);
+}
+
+uint16_t GameView::black_setup(uint32_t i) const
+{
+    return point(i);
+}
+
+uint16_t GameView::white_setup(uint32_t i) const
+{
+    return point(header->num_black_setup + i);
+}
+
+GameArchive::GameArchive(const std::string &path)
+{
+    data = map_file(path, length);
+    index_data = map_file(archive_index_path(path), index_length);
+    if (data == nullptr || index_data == nullptr || length < sizeof(ArchiveFileHeader) || index_length < sizeof(ArchiveFileHeader) + sizeof(uint64_t))
+    {
+        return;
+    }
+
+    ArchiveFileHeader header;
+    memcpy(&header, data, sizeof(header));
+    ArchiveFileHeader index_header;
+    memcpy(&index_header, index_data, sizeof(index_header));
+    if (header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION || index_header.magic != INDEX_MAGIC || index_header.version != ARCHIVE_VERSION)
+    {
+        std::cout << "Not a version " << ARCHIVE_VERSION << " game archive " << path << '\n';
+        return;
+    }
+
+    // index is the file header, the game count, then one offset per game
+    uint64_t games;
+    memcpy(&games, index_data + sizeof(ArchiveFileHeader), sizeof(games));
+    if (games > index_length / sizeof(uint64_t) || index_length != sizeof(ArchiveFileHeader) + sizeof(uint64_t) * (games + 1))
+    {
+        std::cout << "Truncated index for game archive " << path << '\n';
+        return;
+    }
+    const uint64_t *game_offsets = reinterpret_cast<const uint64_t *>(index_data + sizeof(ArchiveFileHeader) + sizeof(uint64_t));
+    // every game has to lie after the previous one and end inside the mapping, so get_game never hands
+    // out pointers past the end of a truncated or corrupt file
+    uint64_t game_end = sizeof(ArchiveFileHeader);
+    for (uint64_t n = 0; n < games; n++)
+    {
+        if (game_offsets[n] < game_end || game_offsets[n] > length || length - game_offsets[n] < sizeof(GameHeader))
+        {
+            std::cout << "Truncated game archive " << path << '\n';
+            return;
+        }
+        GameHeader game;
+        memcpy(&game, data + game_offsets[n], sizeof(game));
+        // the points are read modulo the size, and SGF files go no bigger than 52x52
+        if (game.size == 0 || game.size > 52)
+        {
+            std::cout << "Corrupt game header in archive " << path << '\n';
+            return;
+        }
+        uint64_t num_points = uint64_t(game.num_black_setup) + game.num_white_setup + game.num_moves;
+        game_end = game_offsets[n] + sizeof(GameHeader) + num_points * (game.flags & GAME_WIDE_POINTS ? 2 : 1);
+        if (game_end > length)
+        {
+            std::cout << "Truncated game archive " << path << '\n';
+            return;
+        }
+    }
+    offsets = game_offsets;
+    count = games;
+}
+
+GameArchive::~GameArchive()
+{
+    if (data != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(data), length);
+    }
+    if (index_data != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(index_data), index_length);
+    }
+}
+
+bool GameArchive::is_valid() const
+{
+    return offsets != nullptr;
+}
+
+uint64_t GameArchive::num_games() const
+{
+    return count;
+}
+
+GameView GameArchive::get_game(uint64_t n) const
+{
+    GameView view;
+    if (n >= count)
+    {
+        return view;
+    }
+    view.header = reinterpret_cast<const GameHeader *>(data + offsets[n]);
+    view.points = data + offsets[n] + sizeof(GameHeader);
+    view.number = n;
+    return view;
+}
+
+std::vector<uint8_t> GameArchiveWriter::encode(const SGFFile &file)
+{
+    uint8_t size = file.get_size();
+    bool wide = size * size >= 0xFF;
+
+    std::vector<uint16_t> black_setup;
+    std::vector<uint16_t> white_setup;
+    for (const SGFMove &stone : file.get_setup())
+    {
+        (stone.black ? black_setup : white_setup).push_back(stone.x + stone.y * size);
+    }
+
+    std::vector<uint16_t> moves;
+    const std::vector<SGFMove> &sgf_moves = file.get_moves();
+    bool black_first = sgf_moves.empty() || sgf_moves[0].black;
+    for (const SGFMove &move : sgf_moves)
+    {
+        bool black_to_play = ((moves.size() & 1) == 0) == black_first;
+        if (move.black != black_to_play)
+        {
+            moves.push_back(ARCHIVE_PASS);
+        }
+        moves.push_back(move.x == SGF_PASS ? ARCHIVE_PASS : move.x + move.y * size);
+    }
+
+    GameHeader header;
+    memset(&header, 0, sizeof(header));
+    header.size = size;
+    header.handicap = file.get_handicap();
+    header.flags = (black_first ? GAME_BLACK_FIRST : 0) | (wide ? GAME_WIDE_POINTS : 0);
+    header.winner = file.get_winner();
+    header.komi = int16_t(file.get_komi() * 2);
+    header.margin = file.get_margin();
+    header.num_black_setup = black_setup.size();
+    header.num_white_setup = white_setup.size();
+    header.num_moves = moves.size();
+
+    std::vector<uint8_t> record(sizeof(header));
+    memcpy(record.data(), &header, sizeof(header));
+    for (const std::vector<uint16_t> *points : {&black_setup, &white_setup, &moves})
+    {
+        for (uint16_t point : *points)
+        {
+            if (wide)
+            {
+                uint8_t bytes[2];
+                memcpy(bytes, &point, sizeof(point));
+                record.push_back(bytes[0]);
+                record.push_back(bytes[1]);
+            }
+            else
+            {
+                record.push_back(point == ARCHIVE_PASS ? 0xFF : point);
+            }
+        }
+    }
+    return record;
+}
+
+GameArchiveWriter::GameArchiveWriter(const std::string &path) : path(path)
+{
+    archive = fopen(path.c_str(), "wb");
+    if (archive == nullptr)
+    {
+        std::cout << "Failed to open file " << path << '\n';
+        return;
+    }
+    ArchiveFileHeader header = {ARCHIVE_MAGIC, ARCHIVE_VERSION, 0};
+    fwrite(&header, sizeof(header), 1, archive);
+    offset = sizeof(header);
+}
+
+GameArchiveWriter::~GameArchiveWriter()
+{
+    close();
+}
+
+bool GameArchiveWriter::is_open() const
+{
+    return archive != nullptr;
+}
+
+bool GameArchiveWriter::add_game(const SGFFile &file)
+{
+    // encode outside the lock, only the write itself is serialised
+    std::vector<uint8_t> record = encode(file);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (archive == nullptr || fwrite(record.data(), 1, record.size(), archive) != record.size())
+    {
+        return false;
+    }
+    offsets.push_back(offset);
+    offset += record.size();
+    return true;
+}
+
+uint64_t GameArchiveWriter::num_games()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return offsets.size();
+}
+
+bool GameArchiveWriter::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (archive == nullptr)
+    {
+        return false;
+    }
+    bool ok = fclose(archive) == 0;
+    archive = nullptr;
+
+    FILE *index = fopen(archive_index_path(path).c_str(), "wb");
+    if (index == nullptr)
+    {
+        std::cout << "Failed to open file " << archive_index_path(path) << '\n';
+        return false;
+    }
+    ArchiveFileHeader header = {INDEX_MAGIC, ARCHIVE_VERSION, 0};
+    uint64_t games = offsets.size();
+    ok = ok && fwrite(&header, sizeof(header), 1, index) == 1;
+    ok = ok && fwrite(&games, sizeof(games), 1, index) == 1;
+    ok = ok && fwrite(offsets.data(), sizeof(uint64_t), games, index) == games;
+    return fclose(index) == 0 && ok;
+}
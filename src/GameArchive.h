@@ -0,0 +1,149 @@
+#ifndef GAME_ARCHIVE_H
+#define GAME_ARCHIVE_H
+/* Compact binary game records. An archive is one file of back to back games plus an index file of
+   offsets so game N can be found in O(1). Points are stored as x + y * size, one byte each on boards
+   up to 15x15 and two bytes on bigger ones. Moves alternate colours starting from the colour in the
+   header, a game where one side plays twice in a row gets a pass inserted for the other side. */
+#include "SGFFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr uint64_t ARCHIVE_MAGIC = 0x5345474c4c455453; // "STELLGES"
+static constexpr uint64_t INDEX_MAGIC = 0x5844494c4c455453;   // "STELLIDX"
+static constexpr uint32_t ARCHIVE_VERSION = 1;
+static constexpr uint16_t ARCHIVE_PASS = 0xFFFF;
+
+// flags in GameHeader
+static constexpr uint8_t GAME_BLACK_FIRST = 1;
+static constexpr uint8_t GAME_WIDE_POINTS = 2; // two bytes per point
+
+#pragma pack(push, 1)
+struct ArchiveFileHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct GameHeader
+{
+    uint8_t size;
+    uint8_t handicap;
+    uint8_t flags;
+    int8_t winner;     // 1 black, -1 white, 0 draw or unknown
+    int16_t komi;      // half points
+    int16_t margin;    // half points or one of the RESULT_ values
+    uint16_t num_black_setup;
+    uint16_t num_white_setup;
+    uint16_t num_moves;
+    uint16_t reserved;
+};
+#pragma pack(pop)
+
+// a game inside a mapped archive, only valid while the archive is
+struct GameView
+{
+    const GameHeader *header = nullptr;
+    const uint8_t *points = nullptr; // black setup, white setup, then moves
+    uint64_t number = 0;             // position in the archive
+
+    uint16_t num_moves() const;
+    // x + y * size, or ARCHIVE_PASS
+    uint16_t move(uint32_t i) const;
+    bool move_is_black(uint32_t i) const;
+    uint16_t black_setup(uint32_t i) const;
+    uint16_t white_setup(uint32_t i) const;
+
+    uint16_t point(uint32_t i) const;
+};
+
+class GameArchive
+{
+public:
+    GameArchive(const std::string &path);
+    ~GameArchive();
+    GameArchive(const GameArchive &) = delete;
+    GameArchive &operator=(const GameArchive &) = delete;
+
+    bool is_valid() const;
+    uint64_t num_games() const;
+    GameView get_game(uint64_t n) const;
+
+protected:
+    const uint8_t *data = nullptr;
+    size_t length = 0;
+    const uint8_t *index_data = nullptr;
+    size_t index_length = 0;
+    const uint64_t *offsets = nullptr;
+    uint64_t count = 0;
+};
+
+class GameArchiveWriter
+{
+public:
+    GameArchiveWriter(const std::string &path);
+    ~GameArchiveWriter();
+
+    bool is_open() const;
+    // safe to call from several threads, games are numbered in the order they get written
+    bool add_game(const SGFFile &file);
+    // writes the index, the archive is unreadable until this has been called
+    bool close();
+    uint64_t num_games();
+
+    static std::vector<uint8_t> encode(const SGFFile &file);
+
+protected:
+    std::string path;
+    FILE *archive = nullptr;
+    std::mutex mutex;
+    std::vector<uint64_t> offsets;
+    uint64_t offset = 0;
+};
+
+std::string archive_index_path(const std::string &path);
+
+// visit(const GameView &, Stats &) runs on a pool of workers over contiguous blocks of games,
+// the per-worker Stats are merged with Stats::add
+template <typename Stats, typename Visit>
+Stats scan_archive(const GameArchive &archive, uint16_t num_threads, Visit visit)
+{
+    num_threads = num_threads ? num_threads : std::max(1U, std::thread::hardware_concurrency());
+    std::vector<Stats> thread_stats(num_threads);
+    std::atomic<uint64_t> next_game{0};
+    const uint64_t block = 256;
+
+    std::vector<std::thread> workers;
+    for (uint16_t t = 0; t < num_threads; t++)
+    {
+        workers.emplace_back([&, t]()
+                             {
+            for (uint64_t start = next_game.fetch_add(block); start < archive.num_games(); start = next_game.fetch_add(block))
+            {
+                for (uint64_t n = start; n < start + block && n < archive.num_games(); n++)
+                {
+                    visit(archive.get_game(n), thread_stats[t]);
+                }
+            } });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    Stats total = Stats();
+    for (const Stats &stats : thread_stats)
+    {
+        total.add(stats);
+    }
+    return total;
+}
+
+#endif
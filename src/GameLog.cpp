@@ -0,0 +1,109 @@
+#include "GameLog.h"
+#include "SGFWriter.h"
+
+#include <iostream>
+
+GameLog::GameLog(logLevel verbosity, const std::string &path, size_t capacity) : verbosity(verbosity), queue(capacity)
+{
+    if (!path.empty())
+    {
+        file = fopen(path.c_str(), "a");
+        if (file == nullptr)
+        {
+            std::cout << "Failed to open file " << path << '\n';
+        }
+    }
+    writer = std::thread(&GameLog::run, this);
+}
+
+GameLog::~GameLog()
+{
+    stopping.store(true, std::memory_order_release);
+    pushed.fetch_add(1, std::memory_order_release);
+    pushed.notify_one();
+    writer.join();
+    if (file != nullptr)
+    {
+        fclose(file);
+    }
+}
+
+bool GameLog::enabled(logLevel level) const
+{
+    return level <= verbosity;
+}
+
+void GameLog::write(logLevel level, std::string text)
+{
+    if (enabled(level))
+    {
+        push(LogRecord{level, "", std::move(text)}, true);
+    }
+}
+
+void GameLog::write_file(std::string path, std::string text)
+{
+    push(LogRecord{LOG_QUIET, std::move(path), std::move(text)}, false);
+}
+
+uint64_t GameLog::get_dropped() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+void GameLog::push(LogRecord record, bool drop_when_full)
+{
+    while (!queue.try_push(record))
+    {
+        if (drop_when_full)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::this_thread::yield();
+    }
+    pushed.fetch_add(1, std::memory_order_release);
+    pushed.notify_one();
+}
+
+void GameLog::run()
+{
+    LogRecord record;
+    while (true)
+    {
+        // read before draining, a push that lands after the drain changes it and the wait falls through
+        uint32_t seen = pushed.load(std::memory_order_acquire);
+        bool wrote_lines = false;
+        while (queue.try_pop(record))
+        {
+            if (!record.path.empty())
+            {
+                if (!save_text_file(record.path, record.text))
+                {
+                    std::cout << "Failed to open file " << record.path << '\n';
+                }
+                continue;
+            }
+            fwrite(record.text.data(), 1, record.text.size(), stdout);
+            if (file != nullptr)
+            {
+                fwrite(record.text.data(), 1, record.text.size(), file);
+            }
+            wrote_lines = true;
+        }
+        // flushed once per batch rather than per line
+        if (wrote_lines)
+        {
+            fflush(stdout);
+            if (file != nullptr)
+            {
+                fflush(file);
+            }
+        }
+        if (stopping.load(std::memory_order_acquire))
+        {
+            break;
+        }
+        pushed.wait(seen, std::memory_order_acquire);
+    }
+}
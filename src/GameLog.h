@@ -0,0 +1,60 @@
+#ifndef GAME_LOG_H
+#define GAME_LOG_H
+/* Console and file output for games, written by a background thread so the threads that play never
+   wait on I/O. They format a record and hand it over through a lock-free queue; the writer thread
+   sleeps until something arrives. Records above the configured verbosity are refused before anyone
+   formats them, so a quiet log costs one comparison per call. */
+#include "LockFreeQueue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+enum logLevel
+{
+    LOG_QUIET = 0,
+    LOG_RESULTS = 1, // one line per finished game
+    LOG_MOVES = 2,   // a line per move
+    LOG_BOARDS = 3   // and the board after it
+};
+
+struct LogRecord
+{
+    logLevel level = LOG_RESULTS;
+    std::string path; // empty for a log line, otherwise a whole file to replace
+    std::string text;
+};
+
+class GameLog
+{
+public:
+    // lines up to verbosity go to stdout and, with a path, are appended to that file too
+    GameLog(logLevel verbosity, const std::string &path = "", size_t capacity = 4096);
+    // writes everything still queued before returning
+    ~GameLog();
+    GameLog(const GameLog &) = delete;
+    GameLog &operator=(const GameLog &) = delete;
+
+    bool enabled(logLevel level) const;
+    // text should end with a newline; never blocks, when the queue is full the line is dropped and counted
+    void write(logLevel level, std::string text);
+    // replaces the file at path with text, e.g. an SGF; these wait for room rather than being dropped
+    void write_file(std::string path, std::string text);
+    uint64_t get_dropped() const;
+
+protected:
+    logLevel verbosity;
+    FILE *file = nullptr;
+    LockFreeQueue<LogRecord> queue;
+    std::atomic<uint32_t> pushed{0}; // the writer sleeps on this
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> dropped{0};
+    std::thread writer;
+
+    void push(LogRecord record, bool drop_when_full);
+    void run();
+};
+
+#endif
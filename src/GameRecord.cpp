@@ -0,0 +1,135 @@
+#include "GameRecord.h"
+
+#include <algorithm>
+
+bool GameRecord::has_setup() const
+{
+    return black_setup.size() || white_setup.size();
+}
+
+uint16_t GameRecord::record_move_number(uint16_t i) const
+{
+    return i + 1 - (std::lower_bound(inserted_passes.begin(), inserted_passes.end(), i) - inserted_passes.begin());
+}
+
+void GameRecord::clear()
+{
+    // keeps the vectors' capacity so a reused record doesn't allocate
+    moves.clear();
+    inserted_passes.clear();
+    black_setup.clear();
+    white_setup.clear();
+    winner = 0;
+    handicap = 0;
+    komi = 0;
+    source.clear();
+}
+
+static void add_move(GameRecord &record, uint16_t idx, bool black)
+{
+    // the board decides whose turn it is from the move count, so keep colours alternating
+    if (((record.moves.size() & 1) == 0) != black)
+    {
+        record.inserted_passes.push_back(record.moves.size());
+        record.moves.push_back(PASS);
+    }
+    record.moves.push_back(idx);
+}
+
+bool load_record(const SGFFile &file, GameRecord &record)
+{
+    record.clear();
+    if (file.get_size() != BOARD_SIZE)
+    {
+        return false;
+    }
+    record.winner = file.get_winner();
+    record.handicap = file.get_handicap();
+    record.komi = file.get_komi();
+    record.source = file.get_path();
+    for (const SGFMove &stone : file.get_setup())
+    {
+        (stone.black ? record.black_setup : record.white_setup).push_back(Board::coords_to_idx(stone.x, stone.y));
+    }
+    for (const SGFMove &move : file.get_moves())
+    {
+        add_move(record, move.x == SGF_PASS ? PASS : Board::coords_to_idx(move.x, move.y), move.black);
+    }
+    return true;
+}
+
+// false for values that aren't on the board, which only a corrupt archive holds
+static bool archive_point(uint16_t point, uint16_t &idx)
+{
+    if (point == ARCHIVE_PASS)
+    {
+        idx = PASS;
+        return true;
+    }
+    if (point >= BOARD_SIZE * BOARD_SIZE)
+    {
+        return false;
+    }
+    idx = Board::coords_to_idx(point % BOARD_SIZE, point / BOARD_SIZE);
+    return true;
+}
+
+bool load_record(const GameView &game, GameRecord &record)
+{
+    record.clear();
+    if (game.header == nullptr || game.header->size != BOARD_SIZE)
+    {
+        return false;
+    }
+    record.winner = game.header->winner;
+    record.handicap = game.header->handicap;
+    record.komi = game.header->komi / 2.0f;
+    record.source = "#" + std::to_string(game.number);
+    uint16_t idx;
+    for (uint32_t i = 0; i < game.header->num_black_setup; i++)
+    {
+        if (!archive_point(game.black_setup(i), idx) || idx == PASS)
+        {
+            return false;
+        }
+        record.black_setup.push_back(idx);
+    }
+    for (uint32_t i = 0; i < game.header->num_white_setup; i++)
+    {
+        if (!archive_point(game.white_setup(i), idx) || idx == PASS)
+        {
+            return false;
+        }
+        record.white_setup.push_back(idx);
+    }
+    for (uint32_t i = 0; i < game.num_moves(); i++)
+    {
+        if (!archive_point(game.move(i), idx))
+        {
+            return false;
+        }
+        add_move(record, idx, game.move_is_black(i));
+    }
+    return true;
+}
+
+bool load_position(const GameRecord &record, uint16_t num_moves, Board &b, uint16_t &played)
+{
+    played = 0;
+    std::array<pointType, NUM_POINTS> stones{};
+    for (uint16_t idx : record.black_setup)
+    {
+        stones[idx] = pointType::BLACK;
+    }
+    for (uint16_t idx : record.white_setup)
+    {
+        stones[idx] = pointType::WHITE;
+    }
+    if (!b.set_position(stones, 0))
+    {
+        return false;
+    }
+    num_moves = std::min<size_t>(num_moves, record.moves.size());
+    played = b.play_sequence(record.moves.data(), num_moves);
+    return played == num_moves;
+}
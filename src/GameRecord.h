@@ -0,0 +1,66 @@
+#ifndef GAME_RECORD_H
+#define GAME_RECORD_H
+/* A recorded game translated to Board point indices, ready to be replayed with make_play. */
+#include "Board.h"
+#include "CorpusScan.h"
+#include "GameArchive.h"
+#include "SGFFile.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct GameRecord
+{
+    // alternating from black, a side that was skipped in the record gets a PASS
+    std::vector<uint16_t> moves;
+    std::vector<uint16_t> inserted_passes; // indices into moves of those PASSes, in increasing order
+    std::vector<uint16_t> black_setup;
+    std::vector<uint16_t> white_setup;
+    int8_t winner = 0; // 1 black, -1 white, 0 draw or unknown
+    uint8_t handicap = 0;
+    float komi = 0;
+    std::string source; // file path, or #N for a game in an archive
+
+    bool has_setup() const;
+    // 1-based number in the original record of moves[i], leaving out the inserted passes
+    uint16_t record_move_number(uint16_t i) const;
+    void clear();
+};
+
+// both return false when the game was played on a different board size than BOARD_SIZE, the archive
+// one also for a point that isn't on the board
+bool load_record(const SGFFile &file, GameRecord &record);
+bool load_record(const GameView &game, GameRecord &record);
+// the position after the setup stones and the first num_moves moves, built with set_position and
+// play_sequence rather than a make_play per move, so ko isn't checked; false if a setup chain has no
+// liberties or a move can't be played, with played set to the number of moves that were
+bool load_position(const GameRecord &record, uint16_t num_moves, Board &b, uint16_t &played);
+
+// runs visit(const GameRecord &, Stats &) over every BOARD_SIZE game in a directory of SGF files or a .sga archive
+template <typename Stats, typename Visit>
+Stats scan_records(const std::string &path, uint16_t num_threads, Visit visit)
+{
+    auto visit_game = [&](const auto &game, Stats &stats)
+    {
+        thread_local GameRecord record;
+        if (load_record(game, record))
+        {
+            visit(record, stats);
+        }
+    };
+
+    if (std::filesystem::path(path).extension() == ".sga")
+    {
+        GameArchive archive(path);
+        if (!archive.is_valid())
+        {
+            std::cout << "Failed to open archive " << path << '\n';
+            return Stats();
+        }
+        return scan_archive<Stats>(archive, num_threads, visit_game);
+    }
+    return scan_corpus<Stats>(path, num_threads, visit_game);
+}
+
+#endif
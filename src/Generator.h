@@ -0,0 +1,110 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+/* Minimal C++20 generator: a coroutine that co_yields values and is read with a range for loop. The
+   body only runs while the caller asks for the next value, so a generator that isn't being read costs a
+   heap frame and no thread. Destroying it early simply never resumes the body again. */
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+template <typename T>
+class Generator
+{
+public:
+    struct promise_type
+    {
+        std::optional<T> value;
+        std::exception_ptr exception;
+
+        Generator get_return_object()
+        {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        // nothing runs until the first value is asked for
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_always yield_value(T yielded)
+        {
+            value = std::move(yielded);
+            return {};
+        }
+        void return_void()
+        {
+        }
+        void unhandled_exception()
+        {
+            exception = std::current_exception();
+        }
+    };
+
+    class iterator
+    {
+    public:
+        explicit iterator(std::coroutine_handle<promise_type> handle) : handle(handle)
+        {
+        }
+        const T &operator*() const
+        {
+            return *handle.promise().value;
+        }
+        iterator &operator++()
+        {
+            resume(handle);
+            return *this;
+        }
+        bool operator==(std::default_sentinel_t) const
+        {
+            return !handle || handle.done();
+        }
+
+    protected:
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    explicit Generator(std::coroutine_handle<promise_type> handle) : handle(handle)
+    {
+    }
+    Generator(Generator &&other) noexcept : handle(std::exchange(other.handle, {}))
+    {
+    }
+    Generator(const Generator &) = delete;
+    Generator &operator=(const Generator &) = delete;
+    ~Generator()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    iterator begin()
+    {
+        resume(handle);
+        return iterator(handle);
+    }
+    std::default_sentinel_t end()
+    {
+        return {};
+    }
+
+protected:
+    std::coroutine_handle<promise_type> handle;
+
+    static void resume(std::coroutine_handle<promise_type> handle)
+    {
+        handle.resume();
+        if (handle.done() && handle.promise().exception)
+        {
+            std::rethrow_exception(handle.promise().exception);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,401 @@
+#include "LifeSolver.h"
+
+#include <algorithm>
+
+static constexpr uint32_t PN_INFINITY = 100000000;
+
+static constexpr uint64_t life_white_to_move = zobrist_table(ZOBRIST_SEED + 3)[0];
+static constexpr uint64_t life_after_pass = zobrist_table(ZOBRIST_SEED + 3)[1];
+
+LifeSolver::LifeSolver(size_t hash_megabytes)
+{
+    size_t num_entries = 1;
+    while (num_entries * 2 * sizeof(Entry) <= hash_megabytes * 1024 * 1024)
+    {
+        num_entries *= 2;
+    }
+    table.assign(num_entries, Entry{});
+    mask = num_entries - 1;
+    set_region({});
+}
+
+void LifeSolver::set_region(const std::vector<uint16_t> &points)
+{
+    in_region.fill(false);
+    uint16_t region_size = 0;
+    for (uint16_t y = 0; y < BOARD_SIZE; y++)
+    {
+        for (uint16_t x = 0; x < BOARD_SIZE; x++)
+        {
+            uint16_t idx = Board::coords_to_idx(x, y);
+            in_region[idx] = points.empty() || std::find(points.begin(), points.end(), idx) != points.end();
+            region_size += in_region[idx];
+        }
+    }
+    // room to fill the region once from each side, and some for captures and passes
+    default_max_ply = 2 * region_size + 16;
+    set_max_ply(0);
+}
+
+void LifeSolver::set_max_ply(uint16_t plies)
+{
+    max_ply = plies ? plies : default_max_ply;
+    stack.resize(max_ply + 2);
+    path.resize(max_ply + 2);
+    children.resize(max_ply + 2);
+}
+
+void LifeSolver::set_node_limit(uint64_t nodes)
+{
+    node_limit = nodes;
+}
+
+bool LifeSolver::is_unconditionally_alive(const Board &b, uint16_t idx)
+{
+    pointType colour = b.board[idx];
+    if ((colour != pointType::BLACK && colour != pointType::WHITE) || b.chain_liberties[b.chain_roots[idx]] < 2)
+    {
+        return false;
+    }
+
+    // the regions colour encloses: everything else, flood filled, with the chains around each region
+    // and whether it is vital to them, every empty point in it one of their liberties
+    std::array<uint16_t, NUM_POINTS> region_of{}; // region number plus one, 0 for colour's stones and the border
+    std::array<uint16_t, NUM_POINTS> points;
+    std::array<uint16_t, NUM_POINTS + 1> first_border;
+    std::array<uint16_t, 4 * NUM_POINTS> border_chains;
+    std::array<bool, 4 * NUM_POINTS> vital;
+    uint16_t num_regions = 0;
+    uint16_t num_borders = 0;
+    for (uint16_t start = 0; start < NUM_POINTS; start++)
+    {
+        if (b.board[start] == colour || b.board[start] == pointType::BLANK || region_of[start] != 0)
+        {
+            continue;
+        }
+        first_border[num_regions++] = num_borders;
+        region_of[start] = num_regions;
+        points[0] = start;
+        uint16_t size = 1;
+        bool all_liberties = true; // every empty point touches one of colour's chains
+        for (uint16_t next = 0; next < size; next++)
+        {
+            uint16_t point = points[next];
+            bool touches = false;
+            for (int direction : b.directions)
+            {
+                uint16_t neighbor = point + direction;
+                pointType value = b.board[neighbor];
+                if (value == colour)
+                {
+                    touches = true;
+                    uint16_t root = b.chain_roots[neighbor];
+                    if (std::find(border_chains.begin() + first_border[num_regions - 1], border_chains.begin() + num_borders, root) ==
+                        border_chains.begin() + num_borders)
+                    {
+                        border_chains[num_borders++] = root;
+                    }
+                }
+                else if (value != pointType::BLANK && region_of[neighbor] == 0)
+                {
+                    region_of[neighbor] = num_regions;
+                    points[size++] = neighbor;
+                }
+            }
+            all_liberties &= touches || b.board[point] != pointType::EMPTY;
+        }
+
+        for (uint16_t k = first_border[num_regions - 1]; k < num_borders; k++)
+        {
+            vital[k] = all_liberties;
+            for (uint16_t p = 0; p < size && vital[k]; p++)
+            {
+                if (b.board[points[p]] != pointType::EMPTY)
+                {
+                    continue;
+                }
+                bool liberty = false;
+                for (int direction : b.directions)
+                {
+                    liberty |= b.chain_roots[points[p] + direction] == border_chains[k] && b.board[points[p] + direction] == colour;
+                }
+                vital[k] = liberty;
+            }
+        }
+    }
+    first_border[num_regions] = num_borders;
+
+    // drop chains with fewer than two vital regions, then regions next to a dropped chain, until nothing
+    // changes; the chains left can't be captured
+    std::array<bool, NUM_POINTS> chain_alive{};
+    std::array<bool, NUM_POINTS> region_alive;
+    for (uint16_t k = 0; k < num_borders; k++)
+    {
+        chain_alive[border_chains[k]] = true;
+    }
+    region_alive.fill(true);
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        std::array<uint8_t, NUM_POINTS> vital_regions{};
+        for (uint16_t r = 0; r < num_regions; r++)
+        {
+            for (uint16_t k = first_border[r]; k < first_border[r + 1] && region_alive[r]; k++)
+            {
+                vital_regions[border_chains[k]] += vital[k] && vital_regions[border_chains[k]] < 2;
+            }
+        }
+        for (uint16_t k = 0; k < num_borders; k++)
+        {
+            if (chain_alive[border_chains[k]] && vital_regions[border_chains[k]] < 2)
+            {
+                chain_alive[border_chains[k]] = false;
+                changed = true;
+            }
+        }
+        for (uint16_t r = 0; r < num_regions; r++)
+        {
+            for (uint16_t k = first_border[r]; k < first_border[r + 1] && region_alive[r]; k++)
+            {
+                if (!chain_alive[border_chains[k]])
+                {
+                    region_alive[r] = false;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return chain_alive[b.chain_roots[idx]];
+}
+
+int8_t LifeSolver::goal_state(const Board &b, uint16_t target, pointType owner, lifeGoal goal)
+{
+    // the target is only ever checked right after each move, so a stone back on its point is never taken for it
+    if (b.get_point(target) != owner)
+    {
+        return goal == GOAL_CAPTURE ? 1 : -1;
+    }
+    if (is_unconditionally_alive(b, target))
+    {
+        return goal == GOAL_CAPTURE ? -1 : 1;
+    }
+    return 0;
+}
+
+int8_t LifeSolver::outcome(const Board &b, int8_t state) const
+{
+    pointType goal_side = goal == GOAL_LIVE ? owner : owner == pointType::BLACK ? pointType::WHITE : pointType::BLACK;
+    bool mover_is_goal_side = (b.whose_turn() ? pointType::BLACK : pointType::WHITE) == goal_side;
+    return mover_is_goal_side == (state > 0) ? 1 : -1;
+}
+
+uint64_t LifeSolver::position_key(const Board &b, bool passed) const
+{
+    uint64_t key = b.get_hash() ^ salt;
+    key ^= b.whose_turn() ? 0 : life_white_to_move;
+    key ^= passed ? life_after_pass : 0;
+    return key;
+}
+
+void LifeSolver::lookup(uint64_t key, uint32_t &phi, uint32_t &delta) const
+{
+    const Entry &entry = table[key & mask];
+    phi = entry.key == key ? entry.phi : 1;
+    delta = entry.key == key ? entry.delta : 1;
+}
+
+void LifeSolver::store(uint64_t key, uint32_t phi, uint32_t delta)
+{
+    table[key & mask] = Entry{key, phi, delta};
+}
+
+void LifeSolver::child_numbers(const Child &child, uint32_t &phi, uint32_t &delta) const
+{
+    if (child.fixed)
+    {
+        phi = child.fixed > 0 ? 0 : PN_INFINITY;
+        delta = child.fixed > 0 ? PN_INFINITY : 0;
+        return;
+    }
+    lookup(child.key, phi, delta);
+}
+
+void LifeSolver::generate(uint16_t ply, bool passed)
+{
+    const Board &b = stack[ply];
+    std::vector<Child> &list = children[ply];
+    list.clear();
+    auto add = [&](uint16_t move)
+    {
+        Board &child = stack[ply + 1];
+        child = b;
+        if (!child.make_play(move))
+        {
+            return;
+        }
+        // only captures and the path decide a child here, Benson's test is left to mid
+        int8_t fixed = 0;
+        bool captured = child.get_point(target) != owner;
+        if (captured)
+        {
+            fixed = outcome(child, goal == GOAL_CAPTURE ? 1 : -1);
+        }
+        else if ((move == PASS && passed) || ply + 1 >= max_ply ||
+                 (move != PASS && std::find(path.begin(), path.begin() + ply + 1, child.get_hash()) != path.begin() + ply + 1))
+        {
+            fixed = outcome(child, -1);
+        }
+        list.push_back(Child{move, position_key(child, move == PASS), fixed});
+    };
+
+    // the target's liberties first, the search takes the first of equally promising children
+    uint16_t root = b.chain_roots[target];
+    for (int liberties_first = 1; liberties_first >= 0; liberties_first--)
+    {
+        for (uint16_t i = 0; i < NUM_POINTS; i++)
+        {
+            if (!in_region[i] || b.board[i] != pointType::EMPTY)
+            {
+                continue;
+            }
+            bool liberty = false;
+            bool own_eye = b.is_eye(i) == (b.whose_turn() ? pointType::BLACK : pointType::WHITE);
+            for (int direction : b.directions)
+            {
+                liberty |= b.chain_roots[i + direction] == root;
+                // filling an eye of a chain that isn't in atari only ever takes away an eye
+                own_eye &= b.board[i + direction] == pointType::BLANK || b.get_chain_liberties(i + direction) >= 2;
+            }
+            if (liberty == bool(liberties_first) && !own_eye)
+            {
+                add(i);
+            }
+        }
+    }
+    // passing can't help the side that wants the goal, the opponent would pass as well and end the line
+    if (outcome(b, 1) < 0)
+    {
+        add(PASS);
+    }
+}
+
+void LifeSolver::mid(uint16_t ply, bool passed, uint64_t key, uint32_t phi_threshold, uint32_t delta_threshold)
+{
+    nodes++;
+    if (node_limit && nodes >= node_limit)
+    {
+        stopped = true;
+    }
+    if (stopped)
+    {
+        return;
+    }
+    // Benson's test costs too much to run on every child as it is generated, a position gets it once it is searched
+    if (is_unconditionally_alive(stack[ply], target))
+    {
+        bool won = outcome(stack[ply], goal == GOAL_CAPTURE ? -1 : 1) > 0;
+        store(key, won ? 0 : PN_INFINITY, won ? PN_INFINITY : 0);
+        return;
+    }
+    generate(ply, passed);
+    const std::vector<Child> &list = children[ply];
+
+    while (true)
+    {
+        // the side to move needs one child lost for the opponent, and has to see every child won before
+        // it loses
+        uint32_t phi = PN_INFINITY;
+        uint64_t delta = 0;
+        uint32_t best_delta = PN_INFINITY;
+        uint32_t second_delta = PN_INFINITY;
+        uint32_t best_phi = PN_INFINITY;
+        size_t best = 0;
+        for (size_t k = 0; k < list.size(); k++)
+        {
+            uint32_t child_phi;
+            uint32_t child_delta;
+            child_numbers(list[k], child_phi, child_delta);
+            phi = std::min(phi, child_delta);
+            delta += child_phi;
+            if (child_delta < best_delta)
+            {
+                second_delta = best_delta;
+                best_delta = child_delta;
+                best_phi = child_phi;
+                best = k;
+            }
+            else if (child_delta < second_delta)
+            {
+                second_delta = child_delta;
+            }
+        }
+        delta = std::min<uint64_t>(delta, PN_INFINITY);
+        if (phi >= phi_threshold || delta >= delta_threshold || stopped)
+        {
+            store(key, phi, delta);
+            return;
+        }
+
+        uint32_t child_phi_threshold = delta_threshold - delta + best_phi;
+        uint32_t child_delta_threshold = std::min<uint64_t>(phi_threshold, uint64_t(second_delta) + 1);
+        const Child &child = list[best];
+        stack[ply + 1] = stack[ply];
+        stack[ply + 1].make_play(child.move);
+        path[ply + 1] = stack[ply + 1].get_hash();
+        mid(ply + 1, child.move == PASS, child.key, child_phi_threshold, child_delta_threshold);
+    }
+}
+
+LifeResult LifeSolver::solve(const Board &b, uint16_t target, lifeGoal goal)
+{
+    LifeResult result;
+    // a fresh key space instead of clearing the table
+    salt += 0x9e3779b97f4a7c15;
+    nodes = 0;
+    stopped = false;
+    this->target = target;
+    this->goal = goal;
+    owner = b.get_point(target);
+    if (owner != pointType::BLACK && owner != pointType::WHITE)
+    {
+        return result;
+    }
+    stack[0] = b;
+    path[0] = b.get_hash();
+
+    int8_t state = goal_state(b, target, owner, goal);
+    if (state == 0)
+    {
+        mid(0, false, position_key(b, false), PN_INFINITY, PN_INFINITY);
+    }
+    result.nodes = nodes;
+    if (stopped)
+    {
+        return result;
+    }
+    if (state != 0)
+    {
+        result.status = outcome(b, state) > 0 ? LIFE_WIN : LIFE_LOSS;
+        return result;
+    }
+
+    // the children of the root are still in place, a winning move is one that leaves the opponent lost;
+    // the table is read back rather than trusted to hold the root, which a collision could have replaced
+    uint32_t root_phi = PN_INFINITY;
+    for (const Child &child : children[0])
+    {
+        uint32_t phi;
+        uint32_t delta;
+        child_numbers(child, phi, delta);
+        if (delta == 0)
+        {
+            result.status = LIFE_WIN;
+            result.move = child.move;
+            return result;
+        }
+        root_phi = std::min(root_phi, delta);
+    }
+    result.status = root_phi == PN_INFINITY ? LIFE_LOSS : LIFE_UNKNOWN;
+    return result;
+}
@@ -0,0 +1,106 @@
+#ifndef LIFE_SOLVER_H
+#define LIFE_SOLVER_H
+/* Depth-first proof-number search (df-pn) for life and death. The question is about one chain, the
+   target: can it be captured, or can it make two eyes, with moves restricted to a region around it.
+   Instead of scoring positions the search proves or disproves the goal, always expanding the move
+   that is cheapest to settle, so forced sequences are read out far beyond what a depth-limited
+   alpha-beta over score() can see.
+
+   A position is decided as soon as the target is off the board or is alive by Benson's test, two eyes
+   that nothing can take away. Both sides may pass; two passes in a row, a repeated position or reaching
+   the ply limit all count as the goal not being reached, so a seki is a failure to make two eyes and a
+   target the attacker can't take within the region survives. Like Solver, positions are kept on a
+   stack of boards, one per ply, and proof and disproof numbers go into a table keyed by the stones, the
+   side to move and whether the last move was a pass. The ko history and the path are left out of the
+   key, so in rare ko and repetition fights a number can come from a line with a different history. */
+#include "Board.h"
+
+#include <vector>
+
+enum lifeGoal
+{
+    GOAL_CAPTURE = 0, // the target's opponent wants it off the board
+    GOAL_LIVE = 1     // the target's owner wants two eyes for it
+};
+
+enum lifeStatus
+{
+    LIFE_UNKNOWN = 0, // the node limit stopped the search first
+    LIFE_WIN = 1,     // the side to move gets its way, whichever side of the goal it is on
+    LIFE_LOSS = 2
+};
+
+struct LifeResult
+{
+    lifeStatus status = LIFE_UNKNOWN;
+    uint16_t move = PASS; // a move that wins for the side to move, if there is one
+    uint64_t nodes = 0;
+};
+
+class LifeSolver
+{
+public:
+    LifeSolver(size_t hash_megabytes);
+
+    // moves are only played on these points, plus passes; empty for everywhere
+    void set_region(const std::vector<uint16_t> &points);
+    // longest line followed, 0 for twice the number of points to play on plus 16
+    void set_max_ply(uint16_t plies);
+    // 0 for no limit
+    void set_node_limit(uint64_t nodes);
+    // target is any stone of the chain in question
+    LifeResult solve(const Board &b, uint16_t target, lifeGoal goal);
+
+    // whether goal has been reached for the chain at target, 1 yes, -1 never any more, 0 not decided yet
+    static int8_t goal_state(const Board &b, uint16_t target, pointType owner, lifeGoal goal);
+    // Benson's test: the chain at idx stays on the board whatever the opponent plays, even if its owner
+    // always passes
+    static bool is_unconditionally_alive(const Board &b, uint16_t idx);
+
+protected:
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t phi;   // proof number for the side to move winning
+        uint32_t delta; // and disproof number
+    };
+
+    struct Child
+    {
+        uint16_t move;
+        uint64_t key;
+        int8_t fixed; // 1 or -1 when the child is won or lost for its side to move whatever the table says
+    };
+
+    std::vector<Entry> table;
+    size_t mask = 0;
+    uint64_t salt = 0; // changes with every solve, so the table never has to be cleared
+
+    std::array<bool, NUM_POINTS> in_region{};
+    uint16_t max_ply = 0;
+    uint16_t default_max_ply = 0;
+    uint64_t node_limit = 0;
+
+    uint16_t target = 0;
+    pointType owner = pointType::EMPTY;
+    lifeGoal goal = GOAL_CAPTURE;
+    std::vector<Board> stack;   // stack[ply] is the position after ply moves of the solve
+    std::vector<uint64_t> path; // stone hashes of stack[0..ply], for repetitions
+    std::vector<std::vector<Child>> children; // per ply, so nothing is allocated once they have grown
+    uint64_t nodes = 0;
+    bool stopped = false;
+
+    // 1 if the side to move in b has won once the goal state is state, -1 if it has lost
+    int8_t outcome(const Board &b, int8_t state) const;
+    uint64_t position_key(const Board &b, bool passed) const;
+    // a position that isn't in the table counts as 1 and 1
+    void lookup(uint64_t key, uint32_t &phi, uint32_t &delta) const;
+    void store(uint64_t key, uint32_t phi, uint32_t delta);
+    // the children of stack[ply], those that are already decided come with fixed set
+    void generate(uint16_t ply, bool passed);
+    void child_numbers(const Child &child, uint32_t &phi, uint32_t &delta) const;
+    // expands stack[ply] until its proof number reaches phi_threshold or its disproof number delta_threshold
+    void mid(uint16_t ply, bool passed, uint64_t key, uint32_t phi_threshold, uint32_t delta_threshold);
+};
+
+#endif
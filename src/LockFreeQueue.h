@@ -0,0 +1,104 @@
+#ifndef LOCK_FREE_QUEUE_H
+#define LOCK_FREE_QUEUE_H
+/* Bounded multi-producer multi-consumer queue without locks (Vyukov's ring of sequenced cells). Each
+   cell carries a sequence number telling producers and consumers whose turn it is, so a push or pop is
+   one compare and swap on the shared index plus a release store on the cell. Neither side ever waits:
+   try_push fails when the queue is full and try_pop when it is empty, and the caller decides what to
+   do about it. Use WorkQueue where blocking is the point. */
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+template <typename T>
+class LockFreeQueue
+{
+public:
+    // capacity is rounded up to a power of two
+    LockFreeQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size *= 2;
+        }
+        mask = size - 1;
+        cells = std::make_unique<Cell[]>(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // item is only moved from when the push succeeds, so a failed one can be retried with it
+    bool try_push(T &item)
+    {
+        size_t position = head.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true)
+        {
+            cell = &cells[position & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = intptr_t(sequence) - intptr_t(position);
+            if (difference == 0 && head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+            if (difference < 0)
+            {
+                // the consumer hasn't freed this cell from the previous lap
+                return false;
+            }
+            if (difference > 0)
+            {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(item);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T &item)
+    {
+        size_t position = tail.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true)
+        {
+            cell = &cells[position & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = intptr_t(sequence) - intptr_t(position + 1);
+            if (difference == 0 && tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+            if (difference < 0)
+            {
+                return false;
+            }
+            if (difference > 0)
+            {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->value);
+        // free for the producer one lap ahead
+        cell->sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+protected:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    // apart so producers and consumers don't fight over one cache line
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+#endif
@@ -0,0 +1,213 @@
+#include "Match.h"
+#include "GTPEngine.h"
+#include "SGFWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+
+static constexpr uint8_t MAX_TIMED_DEPTH = 32;
+static constexpr uint16_t MAX_GAME_LENGTH = 3 * BOARD_SIZE * BOARD_SIZE;
+
+bool parse_agent_config(const std::string &spec, AgentConfig &config)
+{
+    std::string options = spec;
+    size_t colon = spec.find(':');
+    if (colon != std::string::npos)
+    {
+        config.name = spec.substr(0, colon);
+        options = spec.substr(colon + 1);
+    }
+    bool depth_given = false;
+    std::istringstream parts(options);
+    for (std::string part; std::getline(parts, part, ',');)
+    {
+        size_t equals = part.find('=');
+        std::string key = part.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : part.substr(equals + 1);
+        if (key == "depth" && !value.empty())
+        {
+            config.depth = std::strtoul(value.c_str(), nullptr, 10);
+            depth_given = true;
+        }
+        else if (key == "time" && !value.empty())
+        {
+            config.seconds = std::strtod(value.c_str(), nullptr);
+        }
+        else if (key == "hash" && !value.empty())
+        {
+            config.hash_megabytes = std::strtoul(value.c_str(), nullptr, 10);
+        }
+        else if (key == "book")
+        {
+            config.book = true;
+        }
+        else if (key == "patterns")
+        {
+            config.patterns = true;
+        }
+        else if (key == "weights" && !value.empty())
+        {
+            config.weights = value;
+        }
+        else if (!key.empty())
+        {
+            return false;
+        }
+    }
+    // with a clock the depth is only a cap
+    if (config.seconds > 0 && !depth_given)
+    {
+        config.depth = MAX_TIMED_DEPTH;
+    }
+    if (config.name.empty())
+    {
+        config.name = spec.empty() ? "default" : spec;
+    }
+    return config.depth > 0;
+}
+
+MatchPlayer::MatchPlayer(const AgentConfig &config, std::shared_ptr<const OpeningBook> book, std::shared_ptr<const PatternTable> patterns) : config(config)
+{
+    if (config.hash_megabytes)
+    {
+        tt = std::make_shared<TranspositionTable>(config.hash_megabytes);
+        agent.set_transposition_table(tt);
+    }
+    if (config.book && book)
+    {
+        agent.set_book(book);
+    }
+    if (config.patterns && patterns)
+    {
+        agent.set_patterns(patterns);
+    }
+    std::shared_ptr<Evaluator> evaluator = std::make_shared<Evaluator>();
+    if (!config.weights.empty() && evaluator->load(config.weights))
+    {
+        agent.set_evaluator(evaluator);
+    }
+}
+
+const AgentConfig &MatchPlayer::get_config() const
+{
+    return config;
+}
+
+void MatchPlayer::new_game()
+{
+    if (tt)
+    {
+        tt->clear();
+    }
+}
+
+uint16_t MatchPlayer::genmove(const Board &b)
+{
+    return agent.search(b, config.depth, config.seconds).first;
+}
+
+MatchGame play_match_game(MatchPlayer &first, MatchPlayer &second, uint32_t number, uint32_t seed, uint16_t random_plies,
+                          const std::vector<uint16_t> &opening)
+{
+    MatchGame game;
+    game.number = number;
+    game.seed = seed;
+    game.first_is_black = number % 2 == 0;
+    first.new_game();
+    second.new_game();
+
+    Board b;
+    for (uint16_t move : opening)
+    {
+        if (!b.make_play(move))
+        {
+            break;
+        }
+        game.moves.push_back(move);
+    }
+    std::mt19937 rng(seed);
+    std::array<uint16_t, NUM_POINTS> legal;
+    for (uint16_t i = 0; i < random_plies; i++)
+    {
+        uint16_t num_legal = b.get_legal_moves(legal);
+        uint16_t move = num_legal ? legal[rng() % num_legal] : PASS;
+        b.make_play(move);
+        game.moves.push_back(move);
+    }
+
+    bool passed = false;
+    while (game.moves.size() < MAX_GAME_LENGTH)
+    {
+        uint8_t player = b.whose_turn() == game.first_is_black ? 0 : 1;
+        auto start = std::chrono::steady_clock::now();
+        uint16_t move = (player == 0 ? first : second).genmove(b);
+        game.think_seconds[player] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        game.searched_moves[player]++;
+        if (!b.make_play(move))
+        {
+            move = PASS;
+            b.make_play(PASS);
+        }
+        game.moves.push_back(move);
+        if (move == PASS && passed)
+        {
+            break;
+        }
+        passed = move == PASS;
+    }
+    game.margin = b.area_score() - komi;
+    return game;
+}
+
+void MatchTotals::add(const MatchGame &game)
+{
+    bool first_won = (game.margin > 0) == game.first_is_black;
+    games++;
+    wins += game.margin == 0 ? 0.5 : first_won;
+    black_wins += game.margin > 0;
+    plies += game.moves.size();
+    for (int p = 0; p < 2; p++)
+    {
+        think_seconds[p] += game.think_seconds[p];
+        searched_moves[p] += game.searched_moves[p];
+    }
+}
+
+std::string match_log_line(const MatchGame &game, const std::string &black, const std::string &white)
+{
+    std::string moves;
+    for (uint16_t move : game.moves)
+    {
+        moves += (moves.empty() ? "" : " ") + gtp_vertex(move);
+    }
+    return std::to_string(game.number) + '\t' + std::to_string(game.seed) + '\t' + black + '\t' + white + '\t' + sgf_result(game.margin) + '\t' + moves + '\n';
+}
+
+static double elo(double score)
+{
+    score = std::clamp(score, 0.001, 0.999);
+    return -400 * std::log10(1 / score - 1);
+}
+
+void print_match_summary(const MatchTotals &totals, const AgentConfig (&configs)[2])
+{
+    if (totals.games == 0)
+    {
+        return;
+    }
+    // normal approximation of the score's 95% interval, carried over to elo
+    double score = totals.wins / totals.games;
+    double margin = 1.96 * std::sqrt(score * (1 - score) / totals.games);
+    for (int p = 0; p < 2; p++)
+    {
+        printf("%s: %.1f ms/move over %u moves\n", configs[p].name.c_str(),
+               totals.searched_moves[p] ? 1000 * totals.think_seconds[p] / totals.searched_moves[p] : 0.0, totals.searched_moves[p]);
+    }
+    printf("%s scores %.1f/%u = %.1f%% +- %.1f%% (elo %+.0f, %+.0f to %+.0f), black won %u\n", configs[0].name.c_str(), totals.wins,
+           totals.games, 100 * score, 100 * margin, elo(score), elo(score - margin), elo(score + margin), totals.black_wins);
+}
@@ -0,0 +1,75 @@
+#ifndef MATCH_H
+#define MATCH_H
+/* Games between two agent configurations, shared by the match runner and anything else that plays
+   engine against engine. A MatchPlayer is an Agent set up from an AgentConfig and is meant to be
+   reused by one thread for many games. */
+#include "Agent.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct AgentConfig
+{
+    std::string name;
+    uint8_t depth = 3;
+    double seconds = 0;        // per move, 0 searches every move to depth
+    size_t hash_megabytes = 0; // 0 for no transposition table
+    bool book = false;
+    bool patterns = false;
+    std::string weights; // evaluation weights file, empty for Board::score
+};
+
+// "name:depth=4,time=0.5,hash=16,book,patterns,weights=FILE", every part is optional
+bool parse_agent_config(const std::string &spec, AgentConfig &config);
+
+class MatchPlayer
+{
+public:
+    MatchPlayer(const AgentConfig &config, std::shared_ptr<const OpeningBook> book, std::shared_ptr<const PatternTable> patterns);
+
+    const AgentConfig &get_config() const;
+    // forgets the previous game's transposition table entries
+    void new_game();
+    uint16_t genmove(const Board &b);
+
+protected:
+    AgentConfig config;
+    Agent agent;
+    std::shared_ptr<TranspositionTable> tt;
+};
+
+struct MatchGame
+{
+    uint32_t number;
+    uint32_t seed;
+    bool first_is_black; // colours alternate from game to game
+    std::vector<uint16_t> moves;
+    float margin; // black's area minus white's minus komi, positive when black wins
+    std::array<double, 2> think_seconds{}; // per player, first player at 0
+    std::array<uint32_t, 2> searched_moves{};
+};
+
+// the opening moves, then random_plies random legal moves drawn from seed, then the players take turns
+// until both pass or the game runs too long
+MatchGame play_match_game(MatchPlayer &first, MatchPlayer &second, uint32_t number, uint32_t seed, uint16_t random_plies,
+                          const std::vector<uint16_t> &opening = {});
+
+struct MatchTotals
+{
+    uint32_t games = 0;
+    double wins = 0; // for the first player, draws count half
+    uint32_t black_wins = 0;
+    std::array<double, 2> think_seconds{};
+    std::array<uint32_t, 2> searched_moves{};
+    uint64_t plies = 0;
+
+    void add(const MatchGame &game);
+};
+
+// the game as a line of the match log, "game seed black white result moves" separated by tabs
+std::string match_log_line(const MatchGame &game, const std::string &black, const std::string &white);
+// time per move for each player and the first player's score with a 95% interval and in elo
+void print_match_summary(const MatchTotals &totals, const AgentConfig (&configs)[2]);
+
+#endif
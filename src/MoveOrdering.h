@@ -0,0 +1,80 @@
+#ifndef MOVE_ORDERING_H
+#define MOVE_ORDERING_H
+/* Static move ordering for the search. Tables are indexed like the board (with its border) and come
+   in one or more game phases, each starting at a play count. Sizes that tools/gen_tables has seen get
+   corpus tables from OrderingTables.h, anything else falls back to rating points by their line. */
+#include "Config.h"
+#include "OrderingTables.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+template <int size>
+constexpr std::array<int8_t, (size + 2) * (size + 2)> line_weights()
+{
+    // first line is bad, third and fourth line best, the centre slightly below neutral
+    constexpr std::array<int8_t, 6> by_line = {-20, 0, 8, 6, 2, 0};
+    std::array<int8_t, (size + 2) * (size + 2)> weights{};
+    for (int row = 0; row < size; row++)
+    {
+        for (int column = 0; column < size; column++)
+        {
+            int line = std::min({row, column, size - 1 - row, size - 1 - column});
+            weights[(row + 1) * (size + 2) + column + 1] = line < int(by_line.size()) ? by_line[line] : -1;
+        }
+    }
+    return weights;
+}
+
+template <int size>
+constexpr std::array<uint16_t, size * size> order_by_weight(const std::array<int8_t, (size + 2) * (size + 2)> &weights)
+{
+    std::array<uint16_t, size * size> order{};
+    for (int row = 0; row < size; row++)
+    {
+        for (int column = 0; column < size; column++)
+        {
+            order[row * size + column] = (row + 1) * (size + 2) + column + 1;
+        }
+    }
+    std::sort(order.begin(), order.end(), [&weights](uint16_t a, uint16_t b)
+              { return weights[a] != weights[b] ? weights[a] > weights[b] : a < b; });
+    return order;
+}
+
+// sizes without generated tables
+template <int size>
+struct OrderingTables
+{
+    static constexpr uint16_t num_phases = 1;
+    static constexpr std::array<uint16_t, 1> phase_starts = {0};
+    static constexpr std::array<std::array<int8_t, (size + 2) * (size + 2)>, 1> point_weights = {line_weights<size>()};
+    static constexpr std::array<std::array<uint16_t, size * size>, 1> move_order = {order_by_weight<size>(line_weights<size>())};
+};
+
+using BoardOrdering = OrderingTables<BOARD_SIZE>;
+static_assert(BoardOrdering::point_weights[0].size() == NUM_POINTS, "ordering tables don't match the board layout");
+
+inline uint16_t ordering_phase(uint16_t play_count)
+{
+    uint16_t phase = 0;
+    while (phase + 1 < BoardOrdering::num_phases && play_count >= BoardOrdering::phase_starts[phase + 1])
+    {
+        phase++;
+    }
+    return phase;
+}
+
+// every point of the board, most promising first for this stage of the game
+inline const std::array<uint16_t, BOARD_SIZE * BOARD_SIZE> &move_checking_order(uint16_t play_count)
+{
+    return BoardOrdering::move_order[ordering_phase(play_count)];
+}
+
+inline int8_t point_weight(uint16_t idx, uint16_t play_count)
+{
+    return BoardOrdering::point_weights[ordering_phase(play_count)][idx];
+}
+
+#endif
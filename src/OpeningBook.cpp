@@ -0,0 +1,205 @@
+#include "OpeningBook.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+uint64_t book_key_check()
+{
+    Board b;
+    b.make_play(Board::coords_to_idx(0, 0));
+    uint8_t symmetry;
+    return b.get_canonical_key(symmetry);
+}
+
+OpeningBook::OpeningBook()
+{
+}
+
+OpeningBook::~OpeningBook()
+{
+    if (data != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(data), length);
+    }
+}
+
+bool OpeningBook::load(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(BookFileHeader))
+    {
+        close(fd);
+        return false;
+    }
+    void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    BookFileHeader header;
+    memcpy(&header, mapping, sizeof(header));
+    if (header.magic != BOOK_MAGIC || header.version != BOOK_VERSION || header.board_size != BOARD_SIZE || header.key_check != book_key_check() || sizeof(header) + header.num_entries * sizeof(BookEntry) != size_t(st.st_size))
+    {
+        std::cout << "Rejected opening book " << path << " (wrong version, board size or zobrist keys)" << '\n';
+        munmap(mapping, st.st_size);
+        return false;
+    }
+
+    data = static_cast<const uint8_t *>(mapping);
+    length = st.st_size;
+    entries = reinterpret_cast<const BookEntry *>(data + sizeof(BookFileHeader));
+    count = header.num_entries;
+    return true;
+}
+
+bool OpeningBook::is_loaded() const
+{
+    return data != nullptr;
+}
+
+uint64_t OpeningBook::num_entries() const
+{
+    return count;
+}
+
+bool OpeningBook::probe(const Board &b, uint16_t &move) const
+{
+    if (count == 0)
+    {
+        return false;
+    }
+    uint8_t symmetry;
+    uint64_t key = b.get_canonical_key(symmetry);
+    const BookEntry *found = std::lower_bound(entries, entries + count, key, [](const BookEntry &entry, uint64_t key)
+                                              { return entry.key < key; });
+    if (found == entries + count || found->key != key)
+    {
+        return false;
+    }
+    // entries for a position are sorted most played first
+    move = Board::inverse_transform_point(symmetry, found->move);
+    return true;
+}
+
+void BookBuilder::add_game(const GameRecord &record, uint16_t max_plies)
+{
+    if (record.has_setup())
+    {
+        return;
+    }
+    Board b;
+    for (uint16_t i = 0; i < max_plies && i < record.moves.size(); i++)
+    {
+        uint16_t move = record.moves[i];
+        uint8_t symmetry;
+        uint64_t key = b.get_canonical_key(symmetry);
+        bool won = record.winner == (b.whose_turn() ? 1 : -1);
+        if (move == PASS || !b.make_play(move))
+        {
+            break;
+        }
+        // games reaching a rotation or reflection of the position count towards the same entry
+        move = Board::transform_point(symmetry, move);
+
+        std::vector<BookMoveCounts> &moves = positions[key];
+        auto it = std::find_if(moves.begin(), moves.end(), [move](const BookMoveCounts &counts)
+                               { return counts.move == move; });
+        if (it == moves.end())
+        {
+            moves.push_back(BookMoveCounts{move, 0, 0});
+            it = moves.end() - 1;
+        }
+        it->plays++;
+        it->wins += won;
+    }
+}
+
+void BookBuilder::add(const BookBuilder &other)
+{
+    for (const auto &[key, other_moves] : other.positions)
+    {
+        std::vector<BookMoveCounts> &moves = positions[key];
+        for (const BookMoveCounts &counts : other_moves)
+        {
+            auto it = std::find_if(moves.begin(), moves.end(), [&counts](const BookMoveCounts &existing)
+                                   { return existing.move == counts.move; });
+            if (it == moves.end())
+            {
+                moves.push_back(counts);
+                continue;
+            }
+            it->plays += counts.plays;
+            it->wins += counts.wins;
+        }
+    }
+}
+
+int64_t BookBuilder::write(const std::string &path, uint32_t min_plays) const
+{
+    std::vector<BookEntry> entries;
+    for (const auto &[key, moves] : positions)
+    {
+        uint32_t total = 0;
+        for (const BookMoveCounts &counts : moves)
+        {
+            total += counts.plays;
+        }
+        if (total < min_plays)
+        {
+            continue;
+        }
+        for (const BookMoveCounts &counts : moves)
+        {
+            BookEntry entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.key = key;
+            entry.plays = counts.plays;
+            entry.wins = counts.wins;
+            entry.move = counts.move;
+            entries.push_back(entry);
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const BookEntry &a, const BookEntry &b)
+              {
+        if (a.key != b.key)
+        {
+            return a.key < b.key;
+        }
+        if (a.plays != b.plays)
+        {
+            return a.plays > b.plays;
+        }
+        return a.move < b.move; });
+
+    FILE *out = fopen(path.c_str(), "wb");
+    if (out == nullptr)
+    {
+        std::cout << "Failed to open file " << path << '\n';
+        return -1;
+    }
+    BookFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = BOOK_MAGIC;
+    header.version = BOOK_VERSION;
+    header.board_size = BOARD_SIZE;
+    header.key_check = book_key_check();
+    header.num_entries = entries.size();
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    ok = ok && fwrite(entries.data(), sizeof(BookEntry), entries.size(), out) == entries.size();
+    ok = fclose(out) == 0 && ok;
+    return ok ? int64_t(entries.size()) : -1;
+}
@@ -0,0 +1,83 @@
+#ifndef OPENING_BOOK_H
+#define OPENING_BOOK_H
+/* Opening book built from a game corpus. The book file is a header and an array of entries sorted by
+   position key, so a loaded book is just a read-only mapping that gets binary searched. Keys are
+   canonical, so all 8 rotations and reflections of a position share their entries. */
+#include "Board.h"
+#include "GameRecord.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static constexpr uint64_t BOOK_MAGIC = 0x4b4f4f424c4c4554; // "TELLBOOK"
+static constexpr uint32_t BOOK_VERSION = 2;
+
+#pragma pack(push, 1)
+struct BookFileHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint16_t board_size;
+    uint16_t reserved;
+    uint64_t key_check; // changes whenever the zobrist keys do, stale books get rejected
+    uint64_t num_entries;
+};
+
+struct BookEntry
+{
+    uint64_t key; // Board::get_canonical_key before the move
+    uint32_t plays;
+    uint32_t wins; // games won by the side that played the move
+    uint16_t move; // turned to the orientation the key stands for
+    uint16_t reserved;
+    uint32_t padding;
+};
+#pragma pack(pop)
+
+class OpeningBook
+{
+public:
+    OpeningBook();
+    ~OpeningBook();
+    OpeningBook(const OpeningBook &) = delete;
+    OpeningBook &operator=(const OpeningBook &) = delete;
+
+    bool load(const std::string &path);
+    bool is_loaded() const;
+    uint64_t num_entries() const;
+    // most played move in this position, false if the book doesn't know it
+    bool probe(const Board &b, uint16_t &move) const;
+
+protected:
+    const uint8_t *data = nullptr;
+    size_t length = 0;
+    const BookEntry *entries = nullptr;
+    uint64_t count = 0;
+};
+
+struct BookMoveCounts
+{
+    uint16_t move;
+    uint32_t plays;
+    uint32_t wins;
+};
+
+// per thread statistics for scan_records
+struct BookBuilder
+{
+    std::unordered_map<uint64_t, std::vector<BookMoveCounts>> positions;
+
+    // replays the first max_plies moves, games with setup stones are skipped
+    void add_game(const GameRecord &record, uint16_t max_plies);
+    void add(const BookBuilder &other);
+    // keeps positions reached in at least min_plays games, returns the number of entries written or -1
+    int64_t write(const std::string &path, uint32_t min_plays) const;
+};
+
+uint64_t book_key_check();
+
+const std::string path_to_book = "opening_book.bin";
+
+#endif
@@ -0,0 +1,236 @@
+#include "Patterns.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+static constexpr int PATTERN_POINTS = 12;
+static constexpr int PATTERN_POINTS_3X3 = 8;
+
+// (column, row) offsets: the ring around the move clockwise from north, then the diamond tips
+static constexpr std::array<std::pair<int, int>, PATTERN_POINTS> pattern_offsets = {{{0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -2}, {2, 0}, {0, 2}, {-2, 0}}};
+
+constexpr std::array<std::array<uint8_t, PATTERN_POINTS>, 8> symmetric_permutations()
+{
+    // for each of the 8 symmetries, which pattern point ends up in each slot
+    // bit 0 mirrors columns, bit 1 mirrors rows, bit 2 swaps them
+    std::array<std::array<uint8_t, PATTERN_POINTS>, 8> permutations{};
+    for (int t = 0; t < 8; t++)
+    {
+        for (int i = 0; i < PATTERN_POINTS; i++)
+        {
+            int dx = pattern_offsets[i].first;
+            int dy = pattern_offsets[i].second;
+            if (t & 4)
+            {
+                std::swap(dx, dy);
+            }
+            std::pair<int, int> image = {t & 1 ? -dx : dx, t & 2 ? -dy : dy};
+            for (int j = 0; j < PATTERN_POINTS; j++)
+            {
+                if (pattern_offsets[j] == image)
+                {
+                    permutations[t][i] = j;
+                }
+            }
+        }
+    }
+    return permutations;
+}
+
+static constexpr auto pattern_permutations = symmetric_permutations();
+
+uint32_t pattern_key(const Board &b, uint16_t idx, bool diamond)
+{
+    static constexpr int width = BOARD_SIZE + 2;
+    int row = idx / width - 1;
+    int column = idx % width - 1;
+    pointType own = b.whose_turn() ? pointType::BLACK : pointType::WHITE;
+    int num_points = diamond ? PATTERN_POINTS : PATTERN_POINTS_3X3;
+
+    std::array<uint32_t, PATTERN_POINTS> values;
+    for (int i = 0; i < num_points; i++)
+    {
+        int r = row + pattern_offsets[i].second;
+        int c = column + pattern_offsets[i].first;
+        values[i] = 3; // off the board
+        if (r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE)
+        {
+            pointType point = b.get_point((r + 1) * width + c + 1);
+            values[i] = point == pointType::EMPTY ? 0 : 1 + (point != own);
+        }
+    }
+
+    // the ring and the tips map onto themselves, so the 3x3 case can ignore the last 4 slots
+    uint32_t key = UINT32_MAX;
+    for (const auto &permutation : pattern_permutations)
+    {
+        uint32_t code = 0;
+        for (int i = 0; i < num_points; i++)
+        {
+            code |= values[permutation[i]] << (2 * i);
+        }
+        key = std::min(key, code);
+    }
+
+    for (int d : b.directions)
+    {
+        pointType point = b.get_point(idx + d);
+        if (point != pointType::BLACK && point != pointType::WHITE)
+        {
+            continue;
+        }
+        uint16_t liberties = b.get_chain_liberties(idx + d);
+        if (point == own && liberties == 1)
+        {
+            key |= PATTERN_SAVE_ATARI;
+        }
+        else if (point != own && liberties == 1)
+        {
+            key |= PATTERN_CAPTURE;
+        }
+        else if (point != own && liberties == 2)
+        {
+            key |= PATTERN_ATARI;
+        }
+    }
+    return key;
+}
+
+bool PatternTable::load(const std::string &path)
+{
+    FILE *in = fopen(path.c_str(), "rb");
+    if (in == nullptr)
+    {
+        return false;
+    }
+    fseek(in, 0, SEEK_END);
+    long length = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    PatternFileHeader header;
+    bool ok = fread(&header, sizeof(header), 1, in) == 1 && header.magic == PATTERN_MAGIC && header.version == PATTERN_VERSION;
+    ok = ok && sizeof(header) + header.num_entries * sizeof(PatternEntry) == size_t(length);
+    if (ok)
+    {
+        entries.resize(header.num_entries);
+        ok = fread(entries.data(), sizeof(PatternEntry), entries.size(), in) == entries.size();
+    }
+    fclose(in);
+    if (!ok)
+    {
+        std::cout << "Rejected pattern table " << path << '\n';
+        entries.clear();
+        return false;
+    }
+    diamond = header.diamond;
+    return true;
+}
+
+bool PatternTable::is_loaded() const
+{
+    return !entries.empty();
+}
+
+uint64_t PatternTable::num_entries() const
+{
+    return entries.size();
+}
+
+uint16_t PatternTable::probability(const Board &b, uint16_t idx) const
+{
+    uint32_t key = pattern_key(b, idx, diamond);
+    auto found = std::lower_bound(entries.begin(), entries.end(), key, [](const PatternEntry &entry, uint32_t key)
+                                  { return entry.key < key; });
+    return found != entries.end() && found->key == key ? found->probability : 0;
+}
+
+void PatternTable::order_moves(const Board &b, uint16_t *moves, uint16_t count) const
+{
+    std::array<std::pair<uint16_t, uint16_t>, NUM_POINTS> scored;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        scored[i] = {probability(b, moves[i]), moves[i]};
+    }
+    std::stable_sort(scored.begin(), scored.begin() + count, [](const std::pair<uint16_t, uint16_t> &a, const std::pair<uint16_t, uint16_t> &b)
+                     { return a.first > b.first; });
+    for (uint16_t i = 0; i < count; i++)
+    {
+        moves[i] = scored[i].second;
+    }
+}
+
+void PatternMiner::add_game(const GameRecord &record, bool diamond)
+{
+    if (record.has_setup())
+    {
+        return;
+    }
+    board = Board();
+    std::array<uint16_t, NUM_POINTS> legal;
+    for (uint16_t move : record.moves)
+    {
+        if (move != PASS)
+        {
+            uint16_t num_legal = board.get_legal_moves(legal);
+            for (uint16_t i = 0; i < num_legal; i++)
+            {
+                PatternCounts &pattern = counts[pattern_key(board, legal[i], diamond)];
+                pattern.seen++;
+                pattern.played += legal[i] == move;
+            }
+            positions++;
+        }
+        if (!board.make_play(move))
+        {
+            break;
+        }
+    }
+}
+
+void PatternMiner::add(const PatternMiner &other)
+{
+    for (const auto &[key, other_counts] : other.counts)
+    {
+        PatternCounts &pattern = counts[key];
+        pattern.seen += other_counts.seen;
+        pattern.played += other_counts.played;
+    }
+    positions += other.positions;
+}
+
+int64_t PatternMiner::write(const std::string &path, uint64_t min_seen, bool diamond) const
+{
+    std::vector<PatternEntry> entries;
+    for (const auto &[key, pattern] : counts)
+    {
+        if (pattern.seen < min_seen)
+        {
+            continue;
+        }
+        PatternEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.key = key;
+        entry.probability = uint16_t(65535 * pattern.played / pattern.seen);
+        entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const PatternEntry &a, const PatternEntry &b)
+              { return a.key < b.key; });
+
+    FILE *out = fopen(path.c_str(), "wb");
+    if (out == nullptr)
+    {
+        std::cout << "Failed to open file " << path << '\n';
+        return -1;
+    }
+    PatternFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PATTERN_MAGIC;
+    header.version = PATTERN_VERSION;
+    header.diamond = diamond;
+    header.num_entries = entries.size();
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    ok = ok && fwrite(entries.data(), sizeof(PatternEntry), entries.size(), out) == entries.size();
+    ok = fclose(out) == 0 && ok;
+    return ok ? int64_t(entries.size()) : -1;
+}
@@ -0,0 +1,81 @@
+#ifndef PATTERNS_H
+#define PATTERNS_H
+/* Local shape patterns around a candidate move, used as move ordering priors. A pattern is the 3x3
+   neighbourhood (optionally the 12 point diamond that adds the points two steps away), coloured
+   relative to the side to move, plus capture and atari flags. It is reduced to the smallest of its
+   8 rotations and reflections, so every shape has one canonical key. */
+#include "Board.h"
+#include "GameRecord.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static constexpr uint64_t PATTERN_MAGIC = 0x535441504c4c4554; // "TELLPATS"
+static constexpr uint32_t PATTERN_VERSION = 1;
+
+// neighbourhood in the low 24 bits (2 bits per point), flags above
+static constexpr uint32_t PATTERN_CAPTURE = 1 << 24;   // takes an opponent chain in atari
+static constexpr uint32_t PATTERN_ATARI = 1 << 25;     // puts an opponent chain in atari
+static constexpr uint32_t PATTERN_SAVE_ATARI = 1 << 26; // next to an own chain in atari
+
+uint32_t pattern_key(const Board &b, uint16_t idx, bool diamond);
+
+#pragma pack(push, 1)
+struct PatternFileHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint8_t diamond;
+    uint8_t reserved[3];
+    uint64_t num_entries;
+};
+
+struct PatternEntry
+{
+    uint32_t key;
+    uint16_t probability; // chance the move gets played when the pattern is on the board, out of 65535
+    uint16_t reserved;
+};
+#pragma pack(pop)
+
+class PatternTable
+{
+public:
+    bool load(const std::string &path);
+    bool is_loaded() const;
+    uint64_t num_entries() const;
+    // 0 for patterns the table doesn't know
+    uint16_t probability(const Board &b, uint16_t idx) const;
+    // stable sorts moves by pattern probability, most likely first
+    void order_moves(const Board &b, uint16_t *moves, uint16_t count) const;
+
+protected:
+    bool diamond = false;
+    std::vector<PatternEntry> entries; // sorted by key
+};
+
+struct PatternCounts
+{
+    uint64_t seen = 0;   // positions where the pattern was a legal move
+    uint64_t played = 0; // positions where it was the move played
+};
+
+// per thread statistics for scan_records
+struct PatternMiner
+{
+    Board board; // reused for every game this worker replays
+    std::unordered_map<uint32_t, PatternCounts> counts;
+    uint64_t positions = 0;
+
+    // replays the game, counting the pattern of every legal move at every position
+    void add_game(const GameRecord &record, bool diamond);
+    void add(const PatternMiner &other);
+    // keeps patterns seen at least min_seen times, returns the number of entries written or -1
+    int64_t write(const std::string &path, uint64_t min_seen, bool diamond) const;
+};
+
+const std::string path_to_patterns = "patterns.bin";
+
+#endif
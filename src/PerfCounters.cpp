@@ -0,0 +1,328 @@
+#include "PerfCounters.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const std::array<const char *, NUM_PERF_REGIONS> region_names = {"make_play", "update_chains", "merge_chains", "capture_chain", "score", "search"};
+
+// the totals stay in the registry after the thread has exited, the counters are closed with it
+struct PerfThreadState
+{
+    int leader_fd = -1;
+    std::array<int, NUM_PERF_EVENTS> fds{};
+    std::array<int, NUM_PERF_EVENTS> slots{}; // position of each event in a group read, -1 if it didn't open
+    uint16_t num_open = 0;
+    std::array<RegionTotals, NUM_PERF_REGIONS> totals{};
+};
+
+static std::mutex registry_mutex;
+static std::vector<PerfThreadState *> registry;
+static std::atomic<uint32_t> region_mask{0};
+static std::atomic<bool> regions_configured{false};
+
+static long perf_event_open(perf_event_attr *attr, int group_fd)
+{
+    // this thread, any cpu
+    return syscall(SYS_perf_event_open, attr, 0, -1, group_fd, 0);
+}
+
+static perf_event_attr event_attr(perfEvent event)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (event)
+    {
+    case EVENT_CYCLES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case EVENT_INSTRUCTIONS:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case EVENT_L1D_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case EVENT_LLC_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case EVENT_BRANCH_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    case NUM_PERF_EVENTS:
+        break;
+    }
+    return attr;
+}
+
+static void close_counters(PerfThreadState &state)
+{
+    for (uint16_t e = 0; e < NUM_PERF_EVENTS; e++)
+    {
+        if (state.slots[e] != -1)
+        {
+            close(state.fds[e]);
+            state.fds[e] = -1;
+        }
+    }
+    state.leader_fd = -1;
+}
+
+// closes the thread's counters when it exits
+struct PerfThreadHandle
+{
+    PerfThreadState *state = nullptr;
+
+    ~PerfThreadHandle()
+    {
+        if (state != nullptr)
+        {
+            close_counters(*state);
+        }
+    }
+};
+
+static PerfThreadState &thread_state()
+{
+    thread_local PerfThreadHandle handle;
+    if (handle.state != nullptr)
+    {
+        return *handle.state;
+    }
+
+    PerfThreadState *state = new PerfThreadState();
+    handle.state = state;
+    int first_error = 0;
+    for (uint16_t e = 0; e < NUM_PERF_EVENTS; e++)
+    {
+        perf_event_attr attr = event_attr(perfEvent(e));
+        // the first counter that opens leads the group so one read() returns all of them
+        attr.disabled = state->leader_fd == -1;
+        int fd = perf_event_open(&attr, state->leader_fd);
+        state->fds[e] = fd;
+        state->slots[e] = -1;
+        if (fd == -1)
+        {
+            first_error = first_error ? first_error : errno;
+            continue;
+        }
+        if (state->leader_fd == -1)
+        {
+            state->leader_fd = fd;
+        }
+        state->slots[e] = state->num_open;
+        state->num_open++;
+    }
+
+    if (state->leader_fd != -1)
+    {
+        ioctl(state->leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(state->leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if (registry.empty() && first_error)
+    {
+        // only say so once, the report marks missing events as n/a
+        fprintf(stderr, "perf counters: some events unavailable (%s), check /proc/sys/kernel/perf_event_paranoid\n", strerror(first_error));
+    }
+    registry.push_back(state);
+    return *state;
+}
+
+static void read_sample(PerfThreadState &state, PerfSample &sample)
+{
+    if (state.leader_fd != -1)
+    {
+        // number of events, time enabled, time running, then the values
+        std::array<uint64_t, NUM_PERF_EVENTS + 3> buffer{};
+        if (read(state.leader_fd, buffer.data(), sizeof(buffer)) > 0)
+        {
+            sample.enabled_ns = buffer[1];
+            sample.running_ns = buffer[2];
+            for (uint16_t e = 0; e < NUM_PERF_EVENTS; e++)
+            {
+                if (state.slots[e] != -1)
+                {
+                    sample.events[e] = buffer[3 + state.slots[e]];
+                }
+            }
+        }
+    }
+    sample.time = std::chrono::steady_clock::now();
+}
+
+void perf_set_regions(const std::string &regions)
+{
+    uint32_t mask = 0;
+    size_t start = 0;
+    while (start <= regions.length())
+    {
+        size_t end = regions.find(',', start);
+        end = end == std::string::npos ? regions.length() : end;
+        std::string name = regions.substr(start, end - start);
+        for (uint16_t r = 0; r < NUM_PERF_REGIONS; r++)
+        {
+            if (name == "all" || name == region_names[r])
+            {
+                mask |= 1U << r;
+            }
+        }
+        start = end + 1;
+    }
+    region_mask = mask;
+    regions_configured = true;
+}
+
+bool perf_region_enabled(perfRegion region)
+{
+    if (!regions_configured)
+    {
+        const char *env = getenv("PERF_REGIONS");
+        perf_set_regions(env ? env : "all");
+    }
+    return region_mask & (1U << region);
+}
+
+bool perf_counters_available()
+{
+    return thread_state().num_open > 0;
+}
+
+std::array<RegionTotals, NUM_PERF_REGIONS> collect_perf_totals()
+{
+    std::array<RegionTotals, NUM_PERF_REGIONS> totals{};
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const PerfThreadState *state : registry)
+    {
+        for (uint16_t r = 0; r < NUM_PERF_REGIONS; r++)
+        {
+            totals[r].calls += state->totals[r].calls;
+            totals[r].ns += state->totals[r].ns;
+            totals[r].enabled_ns += state->totals[r].enabled_ns;
+            totals[r].running_ns += state->totals[r].running_ns;
+            for (uint16_t e = 0; e < NUM_PERF_EVENTS; e++)
+            {
+                totals[r].events[e] += state->totals[r].events[e];
+            }
+        }
+    }
+    return totals;
+}
+
+void print_perf_report()
+{
+    std::array<RegionTotals, NUM_PERF_REGIONS> totals = collect_perf_totals();
+
+    // an event counts as available if any thread opened it
+    std::array<bool, NUM_PERF_EVENTS> available{};
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (const PerfThreadState *state : registry)
+        {
+            for (uint16_t e = 0; e < NUM_PERF_EVENTS; e++)
+            {
+                available[e] = available[e] || state->slots[e] != -1;
+            }
+        }
+    }
+
+    uint16_t regions_called = 0;
+    bool multiplexed = false;
+    printf("%-14s %12s %10s %10s %10s %6s %10s %10s %10s\n", "region", "calls", "ns/call", "cyc/call", "ins/call", "IPC", "L1D/call", "LLC/call", "brm/call");
+    for (uint16_t r = 0; r < NUM_PERF_REGIONS; r++)
+    {
+        const RegionTotals &t = totals[r];
+        if (t.calls == 0)
+        {
+            continue;
+        }
+        regions_called++;
+        double calls = double(t.calls);
+        // when the group shared the PMU with other events it only counted part of the time, the counts
+        // are scaled up like perf stat does; a group that never got on is n/a
+        bool counted = t.running_ns > 0;
+        double scale = counted ? double(t.enabled_ns) / double(t.running_ns) : 0;
+        multiplexed = multiplexed || t.running_ns < t.enabled_ns;
+        printf("%-14s %12lu %10.1f", region_names[r], (unsigned long)t.calls, t.ns / calls);
+        for (uint16_t e = 0; e < NUM_PERF_EVENTS; e++)
+        {
+            if (e == EVENT_L1D_MISSES)
+            {
+                // IPC sits between the totals and the miss rates
+                if (counted && available[EVENT_CYCLES] && available[EVENT_INSTRUCTIONS] && t.events[EVENT_CYCLES])
+                {
+                    printf(" %6.2f", double(t.events[EVENT_INSTRUCTIONS]) / double(t.events[EVENT_CYCLES]));
+                }
+                else
+                {
+                    printf(" %6s", "n/a");
+                }
+            }
+            if (counted && available[e])
+            {
+                printf(" %10.2f", t.events[e] * scale / calls);
+            }
+            else
+            {
+                printf(" %10s", "n/a");
+            }
+        }
+        printf("\n");
+    }
+    if (regions_called > 1)
+    {
+        printf("outer regions include the counter reads of the regions nested in them, narrow PERF_REGIONS to time one alone\n");
+    }
+    if (multiplexed)
+    {
+        printf("counters were multiplexed with other events, the counts are scaled estimates\n");
+    }
+}
+
+PerfRegion::PerfRegion(perfRegion region) : region(region), enabled(perf_region_enabled(region))
+{
+    if (enabled)
+    {
+        read_sample(thread_state(), start);
+    }
+}
+
+PerfRegion::~PerfRegion()
+{
+    if (!enabled)
+    {
+        return;
+    }
+    PerfThreadState &state = thread_state();
+    PerfSample end;
+    read_sample(state, end);
+
+    RegionTotals &totals = state.totals[region];
+    totals.calls++;
+    totals.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end.time - start.time).count();
+    for (uint16_t e = 0; e < NUM_PERF_EVENTS; e++)
+    {
+        totals.events[e] += end.events[e] - start.events[e];
+    }
+    totals.enabled_ns += end.enabled_ns - start.enabled_ns;
+    totals.running_ns += end.running_ns - start.running_ns;
+}
@@ -0,0 +1,90 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+/* Hardware performance counters (perf_event_open) around hot regions of the engine.
+   Only compiled in when PERF_COUNTERS is true. Regions can be narrowed at runtime with
+   PERF_REGIONS=make_play,score,... in the environment; when the kernel refuses to open
+   counters every region still records calls and wall time.
+
+   Every region reads the counters on entry and on exit, nested ones included, and each read is a
+   system call of its own. Those reads land inside the enclosing region, so make_play and search
+   also count the cost of measuring the regions within them; for clean numbers on an outer region
+   leave the inner ones out of PERF_REGIONS. */
+#include "Config.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+enum perfRegion
+{
+    REGION_MAKE_PLAY = 0,
+    REGION_UPDATE_CHAINS = 1,
+    REGION_MERGE_CHAINS = 2,
+    REGION_CAPTURE_CHAIN = 3,
+    REGION_SCORE = 4,
+    REGION_SEARCH = 5,
+    NUM_PERF_REGIONS = 6
+};
+
+enum perfEvent
+{
+    EVENT_CYCLES = 0,
+    EVENT_INSTRUCTIONS = 1,
+    EVENT_L1D_MISSES = 2,
+    EVENT_LLC_MISSES = 3,
+    EVENT_BRANCH_MISSES = 4,
+    NUM_PERF_EVENTS = 5
+};
+
+struct PerfSample
+{
+    std::array<uint64_t, NUM_PERF_EVENTS> events{};
+    // how long the group has been enabled and how long it actually had the counters, they differ once
+    // the kernel multiplexes it with other events
+    uint64_t enabled_ns = 0;
+    uint64_t running_ns = 0;
+    std::chrono::steady_clock::time_point time;
+};
+
+struct RegionTotals
+{
+    uint64_t calls = 0;
+    uint64_t ns = 0;
+    std::array<uint64_t, NUM_PERF_EVENTS> events{}; // as counted, the report scales them up by enabled / running
+    uint64_t enabled_ns = 0;
+    uint64_t running_ns = 0;
+};
+
+// regions are named like the functions they wrap, a comma separated list or "all"
+void perf_set_regions(const std::string &regions);
+bool perf_region_enabled(perfRegion region);
+// true once this thread has managed to open at least one hardware counter
+bool perf_counters_available();
+
+// totals are inclusive, a make_play region also contains its update_chains and capture_chain, along
+// with their counter reads
+std::array<RegionTotals, NUM_PERF_REGIONS> collect_perf_totals();
+void print_perf_report();
+
+class PerfRegion
+{
+public:
+    PerfRegion(perfRegion region);
+    ~PerfRegion();
+
+protected:
+    perfRegion region;
+    bool enabled;
+    PerfSample start;
+};
+
+#if PERF_COUNTERS
+#define PERF_CONCAT_INNER(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_INNER(a, b)
+#define PERF_REGION(region) PerfRegion PERF_CONCAT(perf_region_, __LINE__)(region)
+#else
+#define PERF_REGION(region)
+#endif
+
+#endif
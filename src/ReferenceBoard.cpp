@@ -0,0 +1,170 @@
+#include "ReferenceBoard.h"
+
+static constexpr auto reference_hashes_black = zobrist_table(ZOBRIST_SEED);
+static constexpr auto reference_hashes_white = zobrist_table(ZOBRIST_SEED + 1);
+static constexpr auto reference_symmetries = symmetry_tables();
+static constexpr std::array<int, 4> reference_directions = {-BOARD_SIZE - 2, -1, BOARD_SIZE + 2, 1};
+
+ReferenceBoard::ReferenceBoard()
+{
+    points.fill(pointType::BLANK);
+    for (uint16_t y = 0; y < BOARD_SIZE; y++)
+    {
+        for (uint16_t x = 0; x < BOARD_SIZE; x++)
+        {
+            points[Board::coords_to_idx(x, y)] = pointType::EMPTY;
+        }
+    }
+    last_positions[0] = points;
+    last_positions[1] = points;
+}
+
+uint16_t ReferenceBoard::flood_chain(const std::array<pointType, NUM_POINTS> &stones, uint16_t idx, std::array<bool, NUM_POINTS> &chain) const
+{
+    pointType colour = stones[idx];
+    std::array<bool, NUM_POINTS> liberty{};
+    std::array<uint16_t, NUM_POINTS> stack;
+    uint16_t stack_size = 0;
+    uint16_t liberties = 0;
+    chain.fill(false);
+    chain[idx] = true;
+    stack[stack_size++] = idx;
+    while (stack_size)
+    {
+        uint16_t point = stack[--stack_size];
+        for (int direction : reference_directions)
+        {
+            uint16_t next = point + direction;
+            if (stones[next] == pointType::EMPTY && !liberty[next])
+            {
+                liberty[next] = true;
+                liberties++;
+            }
+            else if (stones[next] == colour && !chain[next])
+            {
+                chain[next] = true;
+                stack[stack_size++] = next;
+            }
+        }
+    }
+    return liberties;
+}
+
+playError ReferenceBoard::place(std::array<pointType, NUM_POINTS> &stones, uint16_t idx) const
+{
+    pointType own = whose_turn() ? pointType::BLACK : pointType::WHITE;
+    pointType opponent = whose_turn() ? pointType::WHITE : pointType::BLACK;
+    if (stones[idx] != pointType::EMPTY)
+    {
+        return PLAY_OCCUPIED;
+    }
+    stones[idx] = own;
+    std::array<bool, NUM_POINTS> chain;
+    for (int direction : reference_directions)
+    {
+        uint16_t next = idx + direction;
+        if (stones[next] == opponent && flood_chain(stones, next, chain) == 0)
+        {
+            for (uint16_t i = 0; i < NUM_POINTS; i++)
+            {
+                stones[i] = chain[i] ? pointType::EMPTY : stones[i];
+            }
+        }
+    }
+    return flood_chain(stones, idx, chain) == 0 ? PLAY_SUICIDE : PLAY_OK;
+}
+
+playError ReferenceBoard::get_play_error(uint16_t idx) const
+{
+    if (idx == PASS)
+    {
+        return PLAY_OK;
+    }
+    std::array<pointType, NUM_POINTS> stones = points;
+    playError error = place(stones, idx);
+    if (error == PLAY_OK && stones == last_positions[!whose_turn()])
+    {
+        return PLAY_KO;
+    }
+    return error;
+}
+
+bool ReferenceBoard::make_play(uint16_t idx)
+{
+    if (idx == PASS)
+    {
+        play_count++;
+        return true;
+    }
+    std::array<pointType, NUM_POINTS> stones = points;
+    if (place(stones, idx) != PLAY_OK || stones == last_positions[!whose_turn()])
+    {
+        return false;
+    }
+    points = stones;
+    last_positions[!whose_turn()] = stones;
+    play_count++;
+    return true;
+}
+
+bool ReferenceBoard::whose_turn() const
+{
+    return (play_count & 1) == 0;
+}
+
+pointType ReferenceBoard::get_point(uint16_t idx) const
+{
+    return points[idx];
+}
+
+uint16_t ReferenceBoard::get_stone_count(bool black) const
+{
+    uint16_t count = 0;
+    for (pointType point : points)
+    {
+        count += point == (black ? pointType::BLACK : pointType::WHITE);
+    }
+    return count;
+}
+
+uint16_t ReferenceBoard::get_chain_liberties(uint16_t idx) const
+{
+    std::array<bool, NUM_POINTS> chain;
+    return flood_chain(points, idx, chain);
+}
+
+void ReferenceBoard::get_all_liberties(std::array<uint16_t, NUM_POINTS> &liberties) const
+{
+    liberties.fill(0);
+    std::array<bool, NUM_POINTS> chain;
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        if ((points[i] != pointType::BLACK && points[i] != pointType::WHITE) || liberties[i])
+        {
+            continue;
+        }
+        // a chain on the board always has a liberty, so 0 means not visited yet
+        uint16_t count = flood_chain(points, i, chain);
+        for (uint16_t j = i; j < NUM_POINTS; j++)
+        {
+            liberties[j] = chain[j] ? count : liberties[j];
+        }
+    }
+}
+
+uint64_t ReferenceBoard::get_symmetric_hash(uint8_t symmetry) const
+{
+    uint64_t hash = 0;
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        if (points[i] == pointType::BLACK)
+        {
+            hash ^= reference_hashes_black[reference_symmetries[symmetry][i]];
+        }
+        else if (points[i] == pointType::WHITE)
+        {
+            hash ^= reference_hashes_white[reference_symmetries[symmetry][i]];
+        }
+    }
+    return hash;
+}
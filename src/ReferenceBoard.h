@@ -0,0 +1,42 @@
+#ifndef REFERENCE_BOARD_H
+#define REFERENCE_BOARD_H
+/* The rules of Board written as plainly as possible, to check the fast board against. Nothing is kept
+   between moves except the stones: chains and liberties are found by flood fill whenever they are
+   needed, hashes are summed from scratch, and ko compares whole positions instead of hashes. It uses
+   the same point layout and zobrist keys as Board, so the two can be compared value for value. */
+#include "Board.h"
+
+#include <array>
+#include <cstdint>
+
+class ReferenceBoard
+{
+public:
+    ReferenceBoard();
+
+    // same rules and return value as Board::make_play
+    bool make_play(uint16_t idx);
+    playError get_play_error(uint16_t idx) const;
+    bool whose_turn() const;
+    pointType get_point(uint16_t idx) const;
+    uint16_t get_stone_count(bool black) const;
+    // liberties of the chain through idx, counted by flood fill
+    uint16_t get_chain_liberties(uint16_t idx) const;
+    // get_chain_liberties for every stone at once, one flood fill per chain; 0 on empty points
+    void get_all_liberties(std::array<uint16_t, NUM_POINTS> &liberties) const;
+    // what Board::get_symmetric_hash should be, symmetry 0 is Board::get_hash
+    uint64_t get_symmetric_hash(uint8_t symmetry) const;
+
+protected:
+    std::array<pointType, NUM_POINTS> points{};
+    uint16_t play_count = 0;
+    // the stones after each side's last move, black's first; a side may not recreate its own
+    std::array<std::array<pointType, NUM_POINTS>, 2> last_positions{};
+
+    // marks the chain through idx in chain and returns its number of liberties
+    uint16_t flood_chain(const std::array<pointType, NUM_POINTS> &stones, uint16_t idx, std::array<bool, NUM_POINTS> &chain) const;
+    // plays idx for the side to move onto stones, taking opponent chains left without liberties
+    playError place(std::array<pointType, NUM_POINTS> &stones, uint16_t idx) const;
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "RootAnalysis.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+std::vector<MoveAnalysis> analyse_root_moves(const Board &b, uint8_t depth, uint16_t num_threads, std::shared_ptr<TranspositionTable> tt,
+                                             std::shared_ptr<const PatternTable> patterns, std::shared_ptr<const Evaluator> evaluator)
+{
+    assert(depth > 0);
+    std::array<uint16_t, NUM_POINTS> legal;
+    uint16_t num_legal = b.get_legal_moves(legal);
+    std::vector<MoveAnalysis> moves(num_legal);
+    if (tt)
+    {
+        tt->new_generation();
+    }
+
+    // moves are handed out one at a time, their subtrees differ too much in size to split them up front
+    std::atomic<uint16_t> next_move{0};
+    auto work = [&]()
+    {
+        Agent agent;
+        agent.set_transposition_table(tt);
+        agent.set_patterns(patterns);
+        agent.set_evaluator(evaluator);
+        for (uint16_t m = next_move++; m < num_legal; m = next_move++)
+        {
+            // one event per root move, so a trace shows how evenly the moves were spread over the threads
+            TRACE_SCOPE("root_move", legal[m]);
+            Board after = b;
+            after.make_play(legal[m]);
+            uint64_t nodes_before = agent.get_node_count();
+            moves[m].move = legal[m];
+            moves[m].score = agent.evaluate(after, depth - 1);
+            moves[m].nodes = agent.get_node_count() - nodes_before;
+            std::vector<uint16_t> rest = agent.principal_variation(after, depth - 1);
+            moves[m].pv = {legal[m]};
+            moves[m].pv.insert(moves[m].pv.end(), rest.begin(), rest.end());
+        }
+    };
+    num_threads = num_threads ? num_threads : std::max(1U, std::thread::hardware_concurrency());
+    num_threads = std::min<uint16_t>(num_threads, std::max<uint16_t>(num_legal, 1));
+    std::vector<std::thread> workers;
+    for (uint16_t t = 1; t < num_threads; t++)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    bool black = b.whose_turn();
+    std::stable_sort(moves.begin(), moves.end(), [black](const MoveAnalysis &x, const MoveAnalysis &y)
+                     { return black ? x.score > y.score : x.score < y.score; });
+    return moves;
+}
+
+std::string format_heatmap(const Board &b, const std::vector<MoveAnalysis> &moves)
+{
+    static constexpr const char *GTP_COLUMNS = "ABCDEFGHJKLMNOPQRSTUVWXYZ";
+    std::array<int32_t, NUM_POINTS> loss;
+    loss.fill(-1);
+    for (const MoveAnalysis &analysis : moves)
+    {
+        loss[analysis.move] = std::abs(analysis.score - moves.front().score);
+    }
+
+    std::string text;
+    char cell[16];
+    for (uint16_t row = 0; row < BOARD_SIZE; row++)
+    {
+        snprintf(cell, sizeof(cell), "%2d", BOARD_SIZE - row);
+        text += cell;
+        for (uint16_t column = 0; column < BOARD_SIZE; column++)
+        {
+            uint16_t idx = Board::coords_to_idx(column, row);
+            pointType point = b.get_point(idx);
+            if (point == pointType::BLACK || point == pointType::WHITE)
+            {
+                text += point == pointType::BLACK ? "   X" : "   O";
+            }
+            else if (loss[idx] < 0)
+            {
+                text += "   .";
+            }
+            else if (loss[idx] >= 1000)
+            {
+                text += " ***";
+            }
+            else
+            {
+                // the best moves show 0
+                snprintf(cell, sizeof(cell), "%4d", loss[idx]);
+                text += cell;
+            }
+        }
+        text += '\n';
+    }
+    text += "  ";
+    for (uint16_t column = 0; column < BOARD_SIZE; column++)
+    {
+        text += std::string("   ") + GTP_COLUMNS[column];
+    }
+    return text + '\n';
+}
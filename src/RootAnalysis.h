@@ -0,0 +1,29 @@
+#ifndef ROOT_ANALYSIS_H
+#define ROOT_ANALYSIS_H
+/* Scores every legal move of a position instead of only the best one. Each root move gets its own full
+   window search so the scores are exact rather than the bounds alpha-beta leaves behind for moves that
+   lost, and the moves are spread over a pool of threads. Alpha and beta are deliberately not shared
+   between the root moves, that would turn the other scores back into bounds; what the threads share is
+   the lockless transposition table, so transpositions found under one move are reused under another. */
+#include "Agent.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct MoveAnalysis
+{
+    uint16_t move;
+    int16_t score; // black minus white, like Agent::search
+    uint64_t nodes;
+    std::vector<uint16_t> pv; // starts with move, followed from the transposition table
+};
+
+// sorted best first for the side to move, depth counts the root move, num_threads 0 uses every core
+std::vector<MoveAnalysis> analyse_root_moves(const Board &b, uint8_t depth, uint16_t num_threads, std::shared_ptr<TranspositionTable> tt,
+                                             std::shared_ptr<const PatternTable> patterns = nullptr, std::shared_ptr<const Evaluator> evaluator = nullptr);
+
+// the board with each analysed point showing how many points worse it is than the best move
+std::string format_heatmap(const Board &b, const std::vector<MoveAnalysis> &moves);
+
+#endif
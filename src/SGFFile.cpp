@@ -1,28 +1,54 @@
 /* Looks through all the SGF files and finds the average move number where each square of the board is occupied. The starpoints will be first */
 #include "SGFFile.h"
+#include "CorpusScan.h"
+#include "GameArchive.h"
 
-void search_files()
+#include <algorithm>
+#include <charconv>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void search_files(const std::string &path, uint16_t num_threads)
 {
-    std::array<std::pair<int, int>, 441> move_count_sums;
-    for (const auto &sgf_file : std::filesystem::recursive_directory_iterator(path_to_games))
+    MoveCountStats stats;
+    if (std::filesystem::path(path).extension() == ".sga")
     {
-        if (sgf_file.path().extension() == ".sgf")
+        // binary archive from sgf_to_archive
+        GameArchive archive(path);
+        if (!archive.is_valid())
         {
-            std::ifstream game_file(sgf_file.path(), std::ios::binary);
-            if (!game_file.is_open())
-            {
-                std::cout << "Failed to open file " << sgf_file.path() << '\n';
-                return;
-            }
-            else
-            {
-                // std::cout << sgf_file.path() << std::endl;
-                SGFFile file = SGFFile(sgf_file.path());
-                file.record_moves(move_count_sums);
-                // break;
-            }
+            std::cout << "Failed to open archive " << path << '\n';
+            return;
         }
+        stats = scan_archive<MoveCountStats>(archive, num_threads, [](const GameView &game, MoveCountStats &thread_stats)
+                                             {
+            int move_count = 0;
+            for (uint32_t i = 0; i < game.num_moves(); i++)
+            {
+                uint16_t point = game.move(i);
+                if (point == ARCHIVE_PASS)
+                {
+                    continue;
+                }
+                int idx = (point % game.header->size + 1) * 21 + point / game.header->size + 1;
+                if (idx >= 441)
+                {
+                    continue;
+                }
+                thread_stats.move_count_sums[idx].first += move_count;
+                thread_stats.move_count_sums[idx].second++;
+                move_count++;
+            } });
+    }
+    else
+    {
+        stats = scan_corpus<MoveCountStats>(path, num_threads, [](const SGFFile &file, MoveCountStats &thread_stats)
+                                            { file.record_moves(thread_stats.move_count_sums); });
     }
+    const std::array<std::pair<int, int>, 441> &move_count_sums = stats.move_count_sums;
 
     for (int i = 0; i < 19; i++)
     {
@@ -36,52 +62,309 @@ void search_files()
     }
 }
 
-void SGFFile::record_moves(std::array<std::pair<int, int>, 441> &move_count_sums)
+void MoveCountStats::add(const MoveCountStats &other)
 {
+    for (uint16_t i = 0; i < move_count_sums.size(); i++)
+    {
+        move_count_sums[i].first += other.move_count_sums[i].first;
+        move_count_sums[i].second += other.move_count_sums[i].second;
+    }
+}
 
-    std::ifstream ifs;
-    std::string line;
-    ifs.open(file_path, std::ifstream::in);
-    while (std::getline(ifs, line))
+void SGFFile::record_moves(std::array<std::pair<int, int>, 441> &move_count_sums) const
+{
+    int move_count = 0;
+    for (const SGFMove &move : moves)
     {
-        if (line.length() && line.at(0) == ';')
+        if (move.x == SGF_PASS)
         {
-            break;
+            continue;
         }
+        int idx = (move.x + 1) * 21 + move.y + 1;
+        if (idx < 0 || idx >= 441)
+        {
+            continue;
+        }
+        std::pair<int, int> current_count = move_count_sums[idx];
+        move_count_sums[idx] = std::pair<int, int>(current_count.first + move_count, current_count.second + 1);
+        move_count++;
     }
+}
 
-    int move_count = 0;
+SGFFile::SGFFile(std::string file_path) : file_path(file_path)
+{
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+            data = static_cast<const char *>(mapping);
+            length = st.st_size;
+        }
+    }
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
 
-    do
+    if (data != nullptr)
     {
-        std::string move = "";
-        for (uint16_t i = 1; i < line.length(); i++)
+        parse(std::string_view(data, length));
+    }
+}
+
+SGFFile::~SGFFile()
+{
+    if (data != nullptr)
+    {
+        munmap(const_cast<char *>(data), length);
+    }
+}
+
+bool SGFFile::parse(std::string_view text)
+{
+    size = 19;
+    handicap = 0;
+    komi = 0;
+    player = 0;
+    result = std::string_view();
+    setup.clear();
+    moves.clear();
+    valid = false;
+    in_root = false;
+    late_setup = false;
+
+    // everything up to the first ')' is the main line, since a variation always
+    // continues through its first child until it closes
+    size_t i = 0;
+    int depth = 0;
+    bool in_node = false;
+    int nodes = 0;
+    std::string_view ident;
+    while (i < text.length())
+    {
+        char c = text[i];
+        if (c == '[')
         {
-            if (line[i] != ';')
+            // property value, ']' can be escaped with a backslash
+            size_t start = i + 1;
+            size_t end = start;
+            while (end < text.length() && text[end] != ']')
+            {
+                end += text[end] == '\\' ? 2 : 1;
+            }
+            if (end >= text.length())
             {
-                move.push_back(line[i]);
-                continue;
+                return false;
             }
+            if (in_node && ident.length())
+            {
+                add_property(ident, text.substr(start, end - start));
+            }
+            i = end + 1;
+            continue;
+        }
 
-            if (move.length() > 3)
+        if (c >= 'A' && c <= 'Z')
+        {
+            // property identifier, old FF[3] files can mix in lower case letters
+            size_t start = i;
+            while (i < text.length() && ((text[i] >= 'A' && text[i] <= 'Z') || (text[i] >= 'a' && text[i] <= 'z')))
             {
-                int x_coord = move.at(2) - 'a';
-                int y_coord = move.at(3) - 'a';
-                int idx = (x_coord + 1) * 21 + y_coord + 1;
-                if (idx < 0 || idx >= 441)
-                {
-                    continue;
-                }
-                std::pair<int, int> current_count = move_count_sums[idx];
-                move_count_sums[idx] = std::pair<int, int>(current_count.first + move_count, current_count.second + 1);
-                // moves.push_back(std::pair<uint8_t, uint8_t>(x_coord, y_coord));
-                move_count++;
-                move = "";
+                i++;
             }
+            ident = text.substr(start, i - start);
+            continue;
+        }
+
+        switch (c)
+        {
+        case '(':
+            depth++;
+            break;
+        case ')':
+            valid = depth > 0 && !late_setup;
+            return valid;
+        case ';':
+            in_node = depth > 0;
+            in_root = in_node && nodes++ == 0;
+            ident = std::string_view();
+            break;
         }
-    } while (std::getline(ifs, line));
+        i++;
+    }
+    return false;
 }
 
-SGFFile::SGFFile(std::string file_path) : file_path(file_path)
+void SGFFile::add_property(std::string_view ident, std::string_view value)
+{
+    if (ident == "B" || ident == "W")
+    {
+        SGFMove move;
+        move.black = ident == "B";
+        move.x = SGF_PASS;
+        move.y = SGF_PASS;
+        // empty and tt (on boards up to 19x19) are both passes
+        if (value.length() == 2 && !(value == "tt" && size <= 19))
+        {
+            uint8_t x = value[0] - 'a';
+            uint8_t y = value[1] - 'a';
+            if (x >= size || y >= size)
+            {
+                return;
+            }
+            move.x = x;
+            move.y = y;
+        }
+        moves.push_back(move);
+    }
+    else if (ident == "AB" || ident == "AW" || ident == "AE")
+    {
+        // stones placed or removed in the middle of a game can't be replayed as moves, so such files are
+        // rejected rather than having them added to the starting position
+        if (!in_root)
+        {
+            late_setup = true;
+            return;
+        }
+        add_setup_stones(value, ident == "AB" ? 1 : ident == "AW" ? -1 : 0);
+    }
+    else if (ident == "SZ")
+    {
+        int parsed = 0;
+        std::from_chars(value.data(), value.data() + value.length(), parsed);
+        if (parsed > 0 && parsed <= 52)
+        {
+            size = parsed;
+        }
+    }
+    else if (ident == "HA")
+    {
+        std::from_chars(value.data(), value.data() + value.length(), handicap);
+    }
+    else if (ident == "KM")
+    {
+        std::from_chars(value.data(), value.data() + value.length(), komi);
+    }
+    else if (ident == "RE")
+    {
+        result = value;
+    }
+    else if (ident == "PL" && moves.empty() && !value.empty())
+    {
+        player = value[0] == 'B' || value[0] == 'b' ? 1 : value[0] == 'W' || value[0] == 'w' ? -1 : 0;
+    }
+}
+
+void SGFFile::add_setup_stones(std::string_view value, int8_t colour)
+{
+    // either a single point or a compressed rectangle like aa:cc
+    if (value.length() != 2 && !(value.length() == 5 && value[2] == ':'))
+    {
+        return;
+    }
+    uint8_t x1 = value[0] - 'a';
+    uint8_t y1 = value[1] - 'a';
+    uint8_t x2 = value.length() == 5 ? value[3] - 'a' : x1;
+    uint8_t y2 = value.length() == 5 ? value[4] - 'a' : y1;
+    for (uint8_t x = std::min(x1, x2); x <= std::max(x1, x2) && x < size; x++)
+    {
+        for (uint8_t y = std::min(y1, y2); y <= std::max(y1, y2) && y < size; y++)
+        {
+            // a later property for the same point replaces the earlier one
+            std::erase_if(setup, [x, y](const SGFMove &stone) { return stone.x == x && stone.y == y; });
+            if (colour)
+            {
+                setup.push_back(SGFMove{x, y, colour > 0});
+            }
+        }
+    }
+}
+
+bool SGFFile::is_valid() const
+{
+    return valid;
+}
+
+const std::string &SGFFile::get_path() const
+{
+    return file_path;
+}
+
+uint8_t SGFFile::get_size() const
+{
+    return size;
+}
+
+uint8_t SGFFile::get_handicap() const
+{
+    return handicap;
+}
+
+int8_t SGFFile::get_player() const
+{
+    return player;
+}
+
+float SGFFile::get_komi() const
+{
+    return komi;
+}
+
+std::string_view SGFFile::get_result() const
+{
+    return result;
+}
+
+int8_t SGFFile::get_winner() const
+{
+    // results look like B+R, W+3.5, B+T, 0 or Draw
+    if (result.length() < 2 || result[1] != '+')
+    {
+        return 0;
+    }
+    switch (result[0])
+    {
+    case 'B':
+        return 1;
+    case 'W':
+        return -1;
+    }
+    return 0;
+}
+
+int16_t SGFFile::get_margin() const
+{
+    if (get_winner() == 0 || result.length() < 3)
+    {
+        return RESULT_UNKNOWN;
+    }
+    std::string_view margin = result.substr(2);
+    switch (margin[0])
+    {
+    case 'R':
+        return RESULT_RESIGN;
+    case 'T':
+        return RESULT_TIME;
+    case 'F':
+        return RESULT_FORFEIT;
+    }
+    float points = 0;
+    std::from_chars(margin.data(), margin.data() + margin.length(), points);
+    return int16_t(points * 2);
+}
+
+const std::vector<SGFMove> &SGFFile::get_setup() const
+{
+    return setup;
+}
+
+const std::vector<SGFMove> &SGFFile::get_moves() const
 {
+    return moves;
 }
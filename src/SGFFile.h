@@ -5,24 +5,88 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include <array>
 #include <vector>
 
+static constexpr uint8_t SGF_PASS = 255; // x and y of a pass move
+
+// winning margins in half points, with special values for results that aren't counted
+static constexpr int16_t RESULT_RESIGN = 32767;
+static constexpr int16_t RESULT_TIME = 32766;
+static constexpr int16_t RESULT_FORFEIT = 32765;
+static constexpr int16_t RESULT_UNKNOWN = 0;
+
+struct SGFMove
+{
+    uint8_t x; // column, 0 is the left edge
+    uint8_t y; // row, 0 is the top edge
+    bool black;
+};
+
+/* Parses a game in place over a read-only mapping of the file. Only the main line is kept, other
+   variations are skipped, and values like the result are views into the mapping so they live as long
+   as the SGFFile does. Setup stones come from the root node only, a file that adds or removes stones
+   later in the main line is invalid. */
 class SGFFile
 {
 public:
     SGFFile(std::string file_path);
+    ~SGFFile();
+    SGFFile(const SGFFile &) = delete;
+    SGFFile &operator=(const SGFFile &) = delete;
+
+    // parses a game held in memory, text has to outlive the result view
+    bool parse(std::string_view text);
+    bool is_valid() const;
+    const std::string &get_path() const;
+
+    void record_moves(std::array<std::pair<int, int>, 441> &move_count_sums) const;
 
-    void record_moves(std::array<std::pair<int, int>, 441> &move_count_sums);
+    uint8_t get_size() const;
+    uint8_t get_handicap() const;
+    // who is to play first from PL, 1 black, -1 white, 0 if the file doesn't say; problems use it
+    int8_t get_player() const;
+    float get_komi() const;
+    std::string_view get_result() const;
+    // 1 if black won, -1 if white won, 0 for draws and unknown results
+    int8_t get_winner() const;
+    int16_t get_margin() const;
+    const std::vector<SGFMove> &get_setup() const;
+    const std::vector<SGFMove> &get_moves() const;
 
 protected:
     std::string file_path;
-    std::vector<std::pair<uint8_t, uint8_t>> moves;
+    const char *data = nullptr;
+    size_t length = 0;
+    bool valid = false;
+
+    uint8_t size = 19;
+    uint8_t handicap = 0;
+    float komi = 0;
+    int8_t player = 0;
+    std::string_view result;
+    std::vector<SGFMove> setup; // AB and AW stones from the root node, less those cleared by AE there
+    std::vector<SGFMove> moves;
+    bool in_root = false;    // while parsing the first node
+    bool late_setup = false; // AB, AW or AE after the root node, which makes the file invalid
+
+    void add_property(std::string_view ident, std::string_view value);
+    // colour 1 adds black stones, -1 white ones and 0 clears the points
+    void add_setup_stones(std::string_view value, int8_t colour);
+};
+
+// per point sums of (move number, times played), indexed like a 19x19 board with a border
+struct MoveCountStats
+{
+    std::array<std::pair<int, int>, 441> move_count_sums{};
+
+    void add(const MoveCountStats &other);
 };
 
 const std::string path_to_games = "games";
 
-void search_files();
+void search_files(const std::string &path = path_to_games, uint16_t num_threads = 0);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,109 @@
+#include "SGFWriter.h"
+
+#include <cmath>
+#include <cstdio>
+
+static std::string sgf_point(uint16_t idx)
+{
+    if (idx == PASS)
+    {
+        return "";
+    }
+    std::pair<int, int> coords = Board::idx_to_coords(idx);
+    return std::string(1, char('a' + coords.second)) + char('a' + coords.first);
+}
+
+// ] and \ have to be escaped inside a value
+static std::string sgf_text(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == ']' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string sgf_result(float margin)
+{
+    if (margin == 0)
+    {
+        return "0";
+    }
+    char text[32];
+    snprintf(text, sizeof(text), "%c+%g", margin > 0 ? 'B' : 'W', std::fabs(margin));
+    return text;
+}
+
+std::string format_sgf(const GameRecord &record, const SGFGameInfo &info)
+{
+    char komi_text[32];
+    snprintf(komi_text, sizeof(komi_text), "%g", record.komi);
+    std::string sgf = "(;GM[1]FF[4]CA[UTF-8]AP[stella]SZ[" + std::to_string(BOARD_SIZE) + "]KM[" + komi_text + "]";
+    if (record.handicap)
+    {
+        sgf += "HA[" + std::to_string(record.handicap) + "]";
+    }
+    if (!info.black_name.empty())
+    {
+        sgf += "PB[" + sgf_text(info.black_name) + "]";
+    }
+    if (!info.white_name.empty())
+    {
+        sgf += "PW[" + sgf_text(info.white_name) + "]";
+    }
+    if (!info.result.empty())
+    {
+        sgf += "RE[" + sgf_text(info.result) + "]";
+    }
+    if (!record.black_setup.empty())
+    {
+        sgf += "AB";
+        for (uint16_t idx : record.black_setup)
+        {
+            sgf += "[" + sgf_point(idx) + "]";
+        }
+    }
+    if (!record.white_setup.empty())
+    {
+        sgf += "AW";
+        for (uint16_t idx : record.white_setup)
+        {
+            sgf += "[" + sgf_point(idx) + "]";
+        }
+    }
+    sgf += "\n";
+    for (size_t i = 0; i < record.moves.size(); i++)
+    {
+        sgf += std::string(i % 2 ? ";W[" : ";B[") + sgf_point(record.moves[i]) + "]";
+        // a line per 10 moves keeps the file readable
+        if (i % 10 == 9)
+        {
+            sgf += "\n";
+        }
+    }
+    sgf += ")\n";
+    return sgf;
+}
+
+bool save_text_file(const std::string &path, const std::string &text)
+{
+    std::string temporary = path + ".tmp";
+    FILE *out = fopen(temporary.c_str(), "wb");
+    if (out == nullptr)
+    {
+        return false;
+    }
+    bool ok = fwrite(text.data(), 1, text.size(), out) == text.size();
+    ok = fclose(out) == 0 && ok;
+    ok = ok && std::rename(temporary.c_str(), path.c_str()) == 0;
+    if (!ok)
+    {
+        std::remove(temporary.c_str());
+    }
+    return ok;
+}
@@ -0,0 +1,23 @@
+#ifndef SGF_WRITER_H
+#define SGF_WRITER_H
+/* Writes games out as SGF, the counterpart of SGFFile. A game that is still going is written the same
+   way without a result, so it can be saved again after every move and opened at any point. */
+#include "GameRecord.h"
+
+#include <string>
+
+struct SGFGameInfo
+{
+    std::string black_name;
+    std::string white_name;
+    std::string result; // RE, e.g. B+3.5 or W+R, empty while the game is still going
+};
+
+// B+margin or W+margin, 0 for a draw
+std::string sgf_result(float margin);
+// the main line of record as a complete SGF file
+std::string format_sgf(const GameRecord &record, const SGFGameInfo &info);
+// replaces path with text through a temporary file, so readers never see half a file
+bool save_text_file(const std::string &path, const std::string &text);
+
+#endif
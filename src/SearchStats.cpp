@@ -0,0 +1,218 @@
+#include "SearchStats.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+struct TraceEvent
+{
+    const char *name;
+    int64_t value;
+    int64_t start_us;
+    int64_t duration_us;
+};
+
+struct ThreadRecord
+{
+    uint32_t thread_id;
+    SearchStats stats;
+    std::vector<TraceEvent> events;
+};
+
+// every thread that records gets a ThreadRecord in this registry, records outlive their threads
+static std::mutex registry_mutex;
+static std::vector<ThreadRecord *> registry;
+static const auto trace_epoch = std::chrono::steady_clock::now();
+
+static ThreadRecord &thread_record()
+{
+    thread_local ThreadRecord *record = nullptr;
+    if (record == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        record = new ThreadRecord();
+        record->thread_id = registry.size();
+        registry.push_back(record);
+    }
+    return *record;
+}
+
+SearchStats &thread_search_stats()
+{
+    return thread_record().stats;
+}
+
+SearchStats collect_search_stats()
+{
+    SearchStats total;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const ThreadRecord *record : registry)
+    {
+        total.add(record->stats);
+    }
+    return total;
+}
+
+void SearchStats::add(const SearchStats &other)
+{
+    for (uint16_t i = 0; i < MAX_PLY; i++)
+    {
+        nodes_per_ply[i] += other.nodes_per_ply[i];
+        cutoffs_per_ply[i] += other.cutoffs_per_ply[i];
+    }
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        cutoff_move_index[i] += other.cutoff_move_index[i];
+    }
+    illegal_plays += other.illegal_plays;
+    ko_checks += other.ko_checks;
+    captures += other.captures;
+    captured_stones += other.captured_stones;
+    merges += other.merges;
+    capture_ns += other.capture_ns;
+    merge_ns += other.merge_ns;
+    tt_probes += other.tt_probes;
+    tt_hits += other.tt_hits;
+    tt_cutoffs += other.tt_cutoffs;
+}
+
+SearchStats SearchStats::since(const SearchStats &start) const
+{
+    // counters only ever grow so this is the work done between the two snapshots
+    SearchStats diff;
+    for (uint16_t i = 0; i < MAX_PLY; i++)
+    {
+        diff.nodes_per_ply[i] = nodes_per_ply[i] - start.nodes_per_ply[i];
+        diff.cutoffs_per_ply[i] = cutoffs_per_ply[i] - start.cutoffs_per_ply[i];
+    }
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        diff.cutoff_move_index[i] = cutoff_move_index[i] - start.cutoff_move_index[i];
+    }
+    diff.illegal_plays = illegal_plays - start.illegal_plays;
+    diff.ko_checks = ko_checks - start.ko_checks;
+    diff.captures = captures - start.captures;
+    diff.captured_stones = captured_stones - start.captured_stones;
+    diff.merges = merges - start.merges;
+    diff.capture_ns = capture_ns - start.capture_ns;
+    diff.merge_ns = merge_ns - start.merge_ns;
+    diff.tt_probes = tt_probes - start.tt_probes;
+    diff.tt_hits = tt_hits - start.tt_hits;
+    diff.tt_cutoffs = tt_cutoffs - start.tt_cutoffs;
+    return diff;
+}
+
+uint64_t SearchStats::total_nodes() const
+{
+    uint64_t total = 0;
+    for (uint16_t i = 0; i < MAX_PLY; i++)
+    {
+        total += nodes_per_ply[i];
+    }
+    return total;
+}
+
+void SearchStats::print() const
+{
+    printf("ply\tnodes\tcutoffs\n");
+    for (uint16_t i = 0; i < MAX_PLY; i++)
+    {
+        if (nodes_per_ply[i] == 0)
+        {
+            continue;
+        }
+        printf("%u\t%lu\t%lu\n", i, (unsigned long)nodes_per_ply[i], (unsigned long)cutoffs_per_ply[i]);
+    }
+
+    // a good move ordering cuts off on the first few candidates
+    uint64_t cutoffs = 0;
+    uint64_t first_move_cutoffs = cutoff_move_index[0];
+    double index_sum = 0;
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        cutoffs += cutoff_move_index[i];
+        index_sum += double(i) * cutoff_move_index[i];
+    }
+    if (cutoffs)
+    {
+        printf("cutoffs: %lu\tfirst move: %.1f%%\tmean index: %.2f\n", (unsigned long)cutoffs,
+               100.0 * first_move_cutoffs / cutoffs, index_sum / cutoffs);
+    }
+    printf("illegal plays: %lu\tko checks: %lu\n", (unsigned long)illegal_plays, (unsigned long)ko_checks);
+    printf("captures: %lu (%lu stones, %.3f ms)\tmerges: %lu (%.3f ms)\n", (unsigned long)captures,
+           (unsigned long)captured_stones, capture_ns / 1e6, (unsigned long)merges, merge_ns / 1e6);
+    if (tt_probes)
+    {
+        printf("tt probes: %lu\thits: %.1f%%\tcutoffs: %.1f%%\n", (unsigned long)tt_probes,
+               100.0 * tt_hits / tt_probes, 100.0 * tt_cutoffs / tt_probes);
+    }
+}
+
+StatsTimer::StatsTimer(uint64_t &target) : target(target), start(std::chrono::steady_clock::now())
+{
+}
+
+StatsTimer::~StatsTimer()
+{
+    target += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+ChainStatsPause::ChainStatsPause()
+    : stats(thread_search_stats()), captures(stats.captures), captured_stones(stats.captured_stones), merges(stats.merges),
+      capture_ns(stats.capture_ns), merge_ns(stats.merge_ns)
+{
+}
+
+ChainStatsPause::~ChainStatsPause()
+{
+    stats.captures = captures;
+    stats.captured_stones = captured_stones;
+    stats.merges = merges;
+    stats.capture_ns = capture_ns;
+    stats.merge_ns = merge_ns;
+}
+
+TraceScope::TraceScope(const char *name, int64_t value) : name(name), value(value), start(std::chrono::steady_clock::now())
+{
+}
+
+TraceScope::~TraceScope()
+{
+    auto end = std::chrono::steady_clock::now();
+    TraceEvent event;
+    event.name = name;
+    event.value = value;
+    event.start_us = std::chrono::duration_cast<std::chrono::microseconds>(start - trace_epoch).count();
+    event.duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    thread_record().events.push_back(event);
+}
+
+bool write_chrome_trace(const std::string &path)
+{
+    std::ofstream out(path);
+    if (!out.is_open())
+    {
+        std::cout << "Failed to open file " << path << '\n';
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const ThreadRecord *record : registry)
+    {
+        out << (first ? "" : ",") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << record->thread_id
+            << ",\"args\":{\"name\":\"thread " << record->thread_id << "\"}}";
+        first = false;
+        for (const TraceEvent &event : record->events)
+        {
+            out << ",{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << record->thread_id
+                << ",\"ts\":" << event.start_us << ",\"dur\":" << event.duration_us
+                << ",\"args\":{\"value\":" << event.value << "}}";
+        }
+    }
+    out << "]}\n";
+    return true;
+}
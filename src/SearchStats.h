@@ -0,0 +1,102 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+/* Search instrumentation. Counters are kept per thread and only compiled in when SEARCH_STATS is true,
+   otherwise every macro below expands to nothing. */
+#include "Config.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+static constexpr auto MAX_PLY = 64;
+
+struct SearchStats
+{
+    std::array<uint64_t, MAX_PLY> nodes_per_ply{};
+    std::array<uint64_t, MAX_PLY> cutoffs_per_ply{};
+    std::array<uint64_t, NUM_POINTS> cutoff_move_index{}; // how far down the move ordering each cutoff happened
+
+    uint64_t illegal_plays = 0; // make_play rejections
+    uint64_t ko_checks = 0;     // board copies made by check_play, for make_play and get_legal_moves alike
+    // the chain counters only cover boards that are played on, not the copies check_play throws away
+    uint64_t captures = 0;        // chains taken off the board
+    uint64_t captured_stones = 0; // stones in those chains
+    uint64_t merges = 0;          // plays that joined two or more chains
+    uint64_t capture_ns = 0;      // wall time in capture_chain
+    uint64_t merge_ns = 0;        // wall time in merge_chains
+    uint64_t tt_probes = 0;
+    uint64_t tt_hits = 0;    // probes that found the position
+    uint64_t tt_cutoffs = 0; // hits deep enough to skip the search
+
+    void add(const SearchStats &other);
+    SearchStats since(const SearchStats &start) const;
+    uint64_t total_nodes() const;
+    void print() const;
+};
+
+// counters for the calling thread
+SearchStats &thread_search_stats();
+// sum over every thread that has recorded anything, including ones that have exited
+SearchStats collect_search_stats();
+
+class StatsTimer
+{
+public:
+    StatsTimer(uint64_t &target);
+    ~StatsTimer();
+
+protected:
+    uint64_t &target;
+    std::chrono::steady_clock::time_point start;
+};
+
+// puts the chain counters of the calling thread back as they were when it goes out of scope, around
+// work on a board copy that is thrown away
+class ChainStatsPause
+{
+public:
+    ChainStatsPause();
+    ~ChainStatsPause();
+
+protected:
+    SearchStats &stats;
+    uint64_t captures;
+    uint64_t captured_stones;
+    uint64_t merges;
+    uint64_t capture_ns;
+    uint64_t merge_ns;
+};
+
+class TraceScope
+{
+public:
+    TraceScope(const char *name, int64_t value = 0);
+    ~TraceScope();
+
+protected:
+    const char *name;
+    int64_t value;
+    std::chrono::steady_clock::time_point start;
+};
+
+// writes every recorded trace event as chrome://tracing / perfetto json
+bool write_chrome_trace(const std::string &path);
+
+#if SEARCH_STATS
+#define STATS_CONCAT_INNER(a, b) a##b
+#define STATS_CONCAT(a, b) STATS_CONCAT_INNER(a, b)
+#define STATS_INC(field) (thread_search_stats().field++)
+#define STATS_ADD(field, n) (thread_search_stats().field += (n))
+#define STATS_TIMER(field) StatsTimer STATS_CONCAT(stats_timer_, __LINE__)(thread_search_stats().field)
+#define TRACE_SCOPE(...) TraceScope STATS_CONCAT(trace_scope_, __LINE__)(__VA_ARGS__)
+#define STATS_PAUSE_CHAINS() ChainStatsPause STATS_CONCAT(stats_pause_, __LINE__)
+#else
+#define STATS_INC(field)
+#define STATS_ADD(field, n)
+#define STATS_TIMER(field)
+#define TRACE_SCOPE(...)
+#define STATS_PAUSE_CHAINS()
+#endif
+
+#endif
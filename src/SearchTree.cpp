@@ -0,0 +1,226 @@
+#include "SearchTree.h"
+
+#include <algorithm>
+#include <sys/mman.h>
+
+static constexpr size_t BLOCK_BYTES = size_t(1) << 21;
+
+bool TreeNode::is_expanded() const
+{
+    return first_child != NO_NODE;
+}
+
+NodeArena::NodeArena(size_t megabytes)
+{
+    static_assert(BLOCK_NODES * sizeof(TreeNode) == BLOCK_BYTES);
+    max_blocks = std::max<size_t>(megabytes * (1 << 20) / BLOCK_BYTES, 1);
+}
+
+NodeArena::~NodeArena()
+{
+    for (TreeNode *block : blocks)
+    {
+        munmap(block, BLOCK_BYTES);
+    }
+}
+
+uint32_t NodeArena::place(uint32_t next, uint16_t count)
+{
+    // a group never straddles two blocks, so its nodes are always contiguous in memory
+    if ((next & (BLOCK_NODES - 1)) + count > BLOCK_NODES)
+    {
+        return (next | (BLOCK_NODES - 1)) + 1;
+    }
+    return next;
+}
+
+uint32_t NodeArena::allocate(uint16_t count)
+{
+    uint32_t start = place(used, count);
+    if (count == 0 || start + count > capacity())
+    {
+        return NO_NODE;
+    }
+    uint32_t block = (start + count - 1) >> BLOCK_BITS;
+    if (block == blocks.size())
+    {
+        void *mapping = mmap(nullptr, BLOCK_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED)
+        {
+            return NO_NODE;
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(mapping, BLOCK_BYTES, MADV_HUGEPAGE);
+#endif
+        blocks.push_back(static_cast<TreeNode *>(mapping));
+    }
+    std::fill_n(&(*this)[start], count, TreeNode());
+    used = start + count;
+    return start;
+}
+
+void NodeArena::reset()
+{
+    used = 0;
+}
+
+uint32_t NodeArena::size() const
+{
+    return used;
+}
+
+uint32_t NodeArena::capacity() const
+{
+    return max_blocks * BLOCK_NODES;
+}
+
+uint32_t NodeArena::compact(uint32_t root)
+{
+    // the kept subtree as groups of siblings (old start, count), with the root as a group of its own
+    std::vector<std::pair<uint32_t, uint16_t>> groups = {{root, 1}};
+    for (size_t g = 0; g < groups.size(); g++)
+    {
+        for (uint32_t i = groups[g].first; i < groups[g].first + groups[g].second; i++)
+        {
+            const TreeNode &node = (*this)[i];
+            if (node.is_expanded())
+            {
+                groups.emplace_back(node.first_child, node.num_children);
+            }
+        }
+    }
+    std::sort(groups.begin(), groups.end());
+
+    // children are always allocated after their parent, so packing the groups in index order moves each
+    // one to where it was or earlier and never over a group that hasn't moved yet
+    std::vector<uint32_t> new_starts(groups.size());
+    uint32_t next = 0;
+    for (size_t g = 0; g < groups.size(); g++)
+    {
+        new_starts[g] = place(next, groups[g].second);
+        next = new_starts[g] + groups[g].second;
+        std::copy_n(&(*this)[groups[g].first], groups[g].second, &(*this)[new_starts[g]]);
+    }
+    for (size_t g = 0; g < groups.size(); g++)
+    {
+        for (uint32_t i = new_starts[g]; i < new_starts[g] + groups[g].second; i++)
+        {
+            TreeNode &node = (*this)[i];
+            if (node.is_expanded())
+            {
+                auto found = std::lower_bound(groups.begin(), groups.end(), std::pair<uint32_t, uint16_t>(node.first_child, 0));
+                node.first_child = new_starts[found - groups.begin()];
+            }
+        }
+    }
+    used = next;
+    return new_starts[0];
+}
+
+TreeNode &NodeArena::operator[](uint32_t idx)
+{
+    return blocks[idx >> BLOCK_BITS][idx & (BLOCK_NODES - 1)];
+}
+
+const TreeNode &NodeArena::operator[](uint32_t idx) const
+{
+    return blocks[idx >> BLOCK_BITS][idx & (BLOCK_NODES - 1)];
+}
+
+SearchTree::SearchTree(size_t megabytes) : arena(megabytes)
+{
+    reset(Board());
+}
+
+void SearchTree::reset(const Board &b)
+{
+    arena.reset();
+    root = arena.allocate(1);
+    root_board = b;
+    full = false;
+}
+
+bool SearchTree::expand(uint32_t node, const Board &b)
+{
+    if ((*this)[node].is_expanded())
+    {
+        return false;
+    }
+    std::array<uint16_t, NUM_POINTS> legal;
+    uint16_t num_legal = b.get_legal_moves(legal);
+    legal[num_legal++] = PASS;
+    uint32_t first = arena.allocate(num_legal);
+    if (first == NO_NODE)
+    {
+        full = true;
+        return false;
+    }
+    for (uint16_t i = 0; i < num_legal; i++)
+    {
+        arena[first + i].move = legal[i];
+    }
+    (*this)[node].first_child = first;
+    (*this)[node].num_children = num_legal;
+    return true;
+}
+
+uint32_t SearchTree::find_child(uint32_t node, uint16_t move) const
+{
+    const TreeNode &parent = (*this)[node];
+    for (uint32_t i = parent.first_child; parent.is_expanded() && i < parent.first_child + parent.num_children; i++)
+    {
+        if (arena[i].move == move)
+        {
+            return i;
+        }
+    }
+    return NO_NODE;
+}
+
+bool SearchTree::reroot(const std::vector<uint16_t> &moves, const Board &b)
+{
+    uint32_t node = root;
+    for (uint16_t move : moves)
+    {
+        node = find_child(node, move);
+        if (node == NO_NODE)
+        {
+            reset(b);
+            return false;
+        }
+    }
+    root = arena.compact(node);
+    root_board = b;
+    full = false;
+    return true;
+}
+
+uint32_t SearchTree::get_root() const
+{
+    return root;
+}
+
+const Board &SearchTree::get_root_board() const
+{
+    return root_board;
+}
+
+uint32_t SearchTree::size() const
+{
+    return arena.size();
+}
+
+bool SearchTree::is_full() const
+{
+    return full;
+}
+
+TreeNode &SearchTree::operator[](uint32_t idx)
+{
+    return arena[idx];
+}
+
+const TreeNode &SearchTree::operator[](uint32_t idx) const
+{
+    return arena[idx];
+}
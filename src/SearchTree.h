@@ -0,0 +1,96 @@
+#ifndef SEARCH_TREE_H
+#define SEARCH_TREE_H
+/* Storage for searches that keep an explicit tree of positions. Nodes live in a bump allocator made of
+   2MB blocks and point at each other with 32 bit indices, so a node is 16 bytes, clearing the tree
+   between searches is O(1), and nothing goes back to the heap until the tree is destroyed. The size is
+   capped when the tree is built, once it is full expand() refuses and the search carries on with the
+   leaves it has. After a move and the reply are played, reroot() keeps the subtree that was searched
+   below them and gives everything else back. */
+#include "Board.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+static constexpr uint32_t NO_NODE = 0xffffffff;
+
+struct TreeNode
+{
+    uint32_t first_child = NO_NODE; // children are allocated together and stored next to each other
+    uint32_t visits = 0;
+    uint16_t move = PASS; // the move that leads here from the parent
+    uint16_t num_children = 0;
+    int16_t score = 0;
+    uint8_t depth = 0; // free for the search, e.g. how deep the score was searched
+    uint8_t flags = 0;
+
+    bool is_expanded() const;
+};
+
+static_assert(sizeof(TreeNode) == 16);
+
+class NodeArena
+{
+public:
+    // capped at megabytes, rounded down to whole blocks but always at least one
+    NodeArena(size_t megabytes);
+    ~NodeArena();
+    NodeArena(const NodeArena &) = delete;
+    NodeArena &operator=(const NodeArena &) = delete;
+
+    // count default nodes next to each other, NO_NODE once the cap is reached
+    uint32_t allocate(uint16_t count);
+    // forgets every node, the blocks are kept for the next search
+    void reset();
+    uint32_t size() const;
+    uint32_t capacity() const;
+    // moves the subtree below root to the front and frees the rest, returns root's new index
+    uint32_t compact(uint32_t root);
+
+    TreeNode &operator[](uint32_t idx);
+    const TreeNode &operator[](uint32_t idx) const;
+
+protected:
+    static constexpr uint32_t BLOCK_BITS = 17;
+    static constexpr uint32_t BLOCK_NODES = 1 << BLOCK_BITS;
+
+    std::vector<TreeNode *> blocks; // mapped on first use
+    uint32_t max_blocks;
+    uint32_t used = 0; // next free index, a group that doesn't fit a block's tail starts the next block
+
+    // where count nodes go if the next free index is next
+    static uint32_t place(uint32_t next, uint16_t count);
+};
+
+class SearchTree
+{
+public:
+    SearchTree(size_t megabytes);
+
+    // starts over from b with a single unexpanded root
+    void reset(const Board &b);
+    // gives node a child for every legal move and a pass, false if it was already expanded or the
+    // arena is full
+    bool expand(uint32_t node, const Board &b);
+    uint32_t find_child(uint32_t node, uint16_t move) const;
+    // follows moves down from the root and keeps what is below them as the new tree, which has to be
+    // the position b; starts over from b if the path was never expanded, returns whether anything was kept
+    bool reroot(const std::vector<uint16_t> &moves, const Board &b);
+
+    uint32_t get_root() const;
+    const Board &get_root_board() const;
+    uint32_t size() const;
+    // set once an expansion was refused for lack of room, cleared by reset
+    bool is_full() const;
+
+    TreeNode &operator[](uint32_t idx);
+    const TreeNode &operator[](uint32_t idx) const;
+
+protected:
+    NodeArena arena;
+    uint32_t root = NO_NODE;
+    Board root_board;
+    bool full = false;
+};
+
+#endif
@@ -0,0 +1,301 @@
+#include "Solver.h"
+#include "MoveOrdering.h"
+
+#include <algorithm>
+
+static constexpr int16_t SOLVE_INFINITY = 32000;
+static constexpr uint8_t SOLVED_DEPTH = 1; // every entry is a final result, so depth only has to be constant
+
+static constexpr uint64_t solver_white_to_move = zobrist_table(ZOBRIST_SEED + 2)[0];
+static constexpr uint64_t solver_after_pass = zobrist_table(ZOBRIST_SEED + 2)[1];
+
+// stored one up so a pass isn't taken for an entry without a move
+static uint16_t to_table_move(uint16_t move, uint8_t symmetry)
+{
+    return Board::transform_point(symmetry, move) + 1;
+}
+
+static uint16_t from_table_move(uint16_t stored, uint8_t symmetry)
+{
+    return stored ? Board::inverse_transform_point(symmetry, stored - 1) : NUM_POINTS;
+}
+
+Solver::Solver(size_t hash_megabytes) : tt(hash_megabytes)
+{
+    set_region({});
+}
+
+void Solver::set_region(const std::vector<uint16_t> &points)
+{
+    whole_board = points.empty();
+    in_region.fill(false);
+    uint16_t region_size = 0;
+    for (uint16_t y = 0; y < BOARD_SIZE; y++)
+    {
+        for (uint16_t x = 0; x < BOARD_SIZE; x++)
+        {
+            uint16_t idx = Board::coords_to_idx(x, y);
+            in_region[idx] = whole_board || std::find(points.begin(), points.end(), idx) != points.end();
+            region_size += in_region[idx];
+        }
+    }
+    // superko ends every line eventually, but capture cycles can take a very long time to get there
+    default_max_ply = 16 * region_size + 8;
+    set_max_ply(0);
+}
+
+void Solver::set_max_ply(uint16_t plies)
+{
+    max_ply = plies ? plies : default_max_ply;
+    stack.resize(max_ply + 2);
+    path.resize(max_ply + 2);
+}
+
+void Solver::set_node_limit(uint64_t nodes)
+{
+    node_limit = nodes;
+}
+
+uint64_t Solver::position_key(uint16_t ply, bool passed, uint8_t &symmetry) const
+{
+    const Board &b = stack[ply];
+    symmetry = 0;
+    uint64_t key = whole_board ? b.get_canonical_hash(symmetry) : b.get_hash();
+    key ^= b.whose_turn() ? 0 : solver_white_to_move;
+    key ^= passed ? solver_after_pass : 0;
+    return key;
+}
+
+bool Solver::fills_own_eye(const Board &b, uint16_t idx) const
+{
+    // with area scoring the eye already counts, so filling it can only take away liberties: a pass does
+    // as well, and there is no need to try both
+    pointType own = b.whose_turn() ? pointType::BLACK : pointType::WHITE;
+    for (int direction : b.directions)
+    {
+        pointType point = b.get_point(idx + direction);
+        if (point != pointType::BLANK && (point != own || b.get_chain_liberties(idx + direction) < 2))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Solver::repeats(uint16_t ply) const
+{
+    // positional superko, a pass leaves the stones as they are and is always allowed
+    for (uint16_t p = 0; p < ply; p++)
+    {
+        if (path[p] == path[ply])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+SolveResult Solver::solve(const Board &b)
+{
+    SolveResult result;
+    nodes = 0;
+    truncated = 0;
+    stopped = false;
+    stack[0] = b;
+    path[0] = b.get_hash();
+
+    // lines that reach the ply limit are scored as won for black and then as lost, if both come to the
+    // same value none of them mattered and it is exact; the lower bound goes last so the table it leaves
+    // behind is the one the score and line come from
+    std::array<int16_t, 2> values{};
+    for (int bound = 1; bound >= 0 && !stopped; bound--)
+    {
+        tt.clear();
+        horizon_score = bound ? BOARD_SIZE * BOARD_SIZE : -BOARD_SIZE * BOARD_SIZE;
+        int16_t value = negamax(0, -SOLVE_INFINITY, SOLVE_INFINITY, false);
+        values[bound] = b.whose_turn() ? value : -value;
+    }
+    result.complete = !stopped;
+    result.lower = values[0];
+    result.upper = values[1];
+    result.exact = result.complete && result.lower == result.upper;
+    result.score = result.exact ? result.lower : 0;
+    result.nodes = nodes;
+    result.truncated = truncated;
+
+    // the line is read back from the table, a move that no longer fits the position ends it early
+    bool passed = false;
+    for (uint16_t ply = 0; result.exact && ply < max_ply; ply++)
+    {
+        uint8_t symmetry;
+        TTEntry entry;
+        if (!tt.probe(position_key(ply, passed, symmetry), entry))
+        {
+            break;
+        }
+        uint16_t move = from_table_move(entry.move, symmetry);
+        stack[ply + 1] = stack[ply];
+        if (move == NUM_POINTS || !stack[ply + 1].make_play(move))
+        {
+            break;
+        }
+        result.line.push_back(move);
+        if (move == PASS && passed)
+        {
+            break;
+        }
+        passed = move == PASS;
+    }
+    return result;
+}
+
+int16_t Solver::negamax(uint16_t ply, int16_t alpha, int16_t beta, bool passed)
+{
+    nodes++;
+    if (node_limit && nodes >= node_limit)
+    {
+        stopped = true;
+    }
+    if (stopped)
+    {
+        return 0;
+    }
+    const Board &b = stack[ply];
+    int16_t sign = b.whose_turn() ? 1 : -1;
+    if (ply >= max_ply)
+    {
+        truncated++;
+        return sign * horizon_score;
+    }
+
+    uint8_t symmetry;
+    uint64_t key = position_key(ply, passed, symmetry);
+    uint16_t hash_move = NUM_POINTS;
+    TTEntry entry;
+    if (tt.probe(key, entry))
+    {
+        bool usable = entry.bound == TT_EXACT || (entry.bound == TT_LOWER && entry.score >= beta) || (entry.bound == TT_UPPER && entry.score <= alpha);
+        if (usable)
+        {
+            return entry.score;
+        }
+        hash_move = from_table_move(entry.move, symmetry);
+    }
+
+    // legal moves in the region, with the ones a symmetry of the position makes redundant left out
+    std::array<uint16_t, NUM_POINTS> candidates;
+    uint16_t num_candidates = 0;
+    std::array<uint8_t, NUM_SYMMETRIES> invariant;
+    uint8_t num_invariant = 0;
+    if (whole_board)
+    {
+        for (uint8_t t = 1; t < NUM_SYMMETRIES; t++)
+        {
+            if (b.get_symmetric_hash(t) == b.get_hash())
+            {
+                invariant[num_invariant++] = t;
+            }
+        }
+    }
+    for (uint16_t i : move_checking_order(b.get_play_count()))
+    {
+        if (!in_region[i] || b.get_point(i) != pointType::EMPTY || fills_own_eye(b, i))
+        {
+            continue;
+        }
+        bool redundant = false;
+        for (uint8_t s = 0; s < num_invariant && !redundant; s++)
+        {
+            redundant = Board::transform_point(invariant[s], i) < i;
+        }
+        if (!redundant)
+        {
+            candidates[num_candidates++] = i;
+        }
+    }
+    candidates[num_candidates++] = PASS;
+    if (hash_move != NUM_POINTS)
+    {
+        uint16_t *found = std::find(candidates.data(), candidates.data() + num_candidates, hash_move);
+        std::rotate(candidates.data(), found, found + (found != candidates.data() + num_candidates));
+    }
+
+    // enhanced transposition cutoffs: a child already known to be good enough ends the node before any searching
+    Board &child = stack[ply + 1];
+    for (uint16_t c = 0; c < num_candidates; c++)
+    {
+        uint16_t move = candidates[c];
+        if (move == PASS && passed)
+        {
+            continue;
+        }
+        child = b;
+        if (!child.make_play(move))
+        {
+            continue;
+        }
+        path[ply + 1] = child.get_hash();
+        if (move != PASS && repeats(ply + 1))
+        {
+            continue;
+        }
+        uint8_t child_symmetry;
+        TTEntry child_entry;
+        if (tt.probe(position_key(ply + 1, move == PASS, child_symmetry), child_entry) &&
+            (child_entry.bound == TT_EXACT || child_entry.bound == TT_UPPER) && -child_entry.score >= beta)
+        {
+            tt.store(key, to_table_move(move, symmetry), -child_entry.score, SOLVED_DEPTH, TT_LOWER);
+            return -child_entry.score;
+        }
+    }
+
+    int16_t alpha_start = alpha;
+    int16_t value = -SOLVE_INFINITY;
+    uint16_t best_move = PASS;
+    for (uint16_t c = 0; c < num_candidates; c++)
+    {
+        uint16_t move = candidates[c];
+        int16_t score;
+        child = b;
+        if (move == PASS && passed)
+        {
+            // the second pass in a row ends the game
+            score = sign * b.area_score();
+        }
+        else
+        {
+            if (!child.make_play(move))
+            {
+                continue;
+            }
+            path[ply + 1] = child.get_hash();
+            if (move != PASS && repeats(ply + 1))
+            {
+                continue;
+            }
+            score = -negamax(ply + 1, -beta, -alpha, move == PASS);
+            if (stopped)
+            {
+                return 0;
+            }
+        }
+        if (score > value)
+        {
+            value = score;
+            best_move = move;
+        }
+        alpha = std::max(alpha, value);
+        if (alpha >= beta)
+        {
+            break;
+        }
+    }
+
+    ttBound bound = value <= alpha_start ? TT_UPPER : TT_EXACT;
+    if (value >= beta)
+    {
+        bound = TT_LOWER;
+    }
+    tt.store(key, to_table_move(best_move, symmetry), value, SOLVED_DEPTH, bound);
+    return value;
+}
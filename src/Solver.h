@@ -0,0 +1,72 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+/* Exact minimax solver for 3x3 boards and for small closed-off regions of a larger one. It plays to the
+   end of the game, two passes in a row, and scores with Tromp-Taylor area counting, so the result is
+   the true value of the position rather than an evaluation. Positional superko is enforced along the
+   current line.
+
+   Boards are kept on a stack with one slot per ply; making a move copies the parent into the next slot
+   and unmaking is dropping back a slot, so nothing is allocated while solving. Positions go into the
+   transposition table under the smallest of their 8 symmetric hashes (full board solves only, a region
+   usually isn't symmetric), and before searching its children a node checks whether one of them is
+   already in the table with a score that cuts it off (enhanced transposition cutoffs).
+
+   Lines can't be followed forever, so the solve runs twice with whatever reaches the ply limit counted
+   first as a win and then as a loss for black. The two results bound the true score and are equal when
+   the limit didn't matter; when they aren't the position is left unresolved. Capture cycles already
+   keep the bounds apart on 4x4 from the empty board, so bigger boards are out of reach. Table entries ignore the path that led to a position, as usual, so in rare
+   superko fights a value can come from a line with a different history. */
+#include "Board.h"
+#include "TranspositionTable.h"
+
+#include <vector>
+
+struct SolveResult
+{
+    int16_t score = 0; // black's area minus white's, without komi, only set when exact
+    int16_t lower = 0; // with every line that reaches the ply limit lost for black
+    int16_t upper = 0; // and won
+    std::vector<uint16_t> line; // optimal play from both sides, ending with the two passes, only when exact
+    uint64_t nodes = 0;
+    uint64_t truncated = 0; // lines cut off at the ply limit
+    bool complete = false;  // false if the node limit stopped the solve first
+    bool exact = false;     // complete and the bounds agree, the ply limit didn't decide anything
+};
+
+class Solver
+{
+public:
+    Solver(size_t hash_megabytes);
+
+    // moves are only played on these points, the rest of the board stays as it is; empty for everywhere
+    void set_region(const std::vector<uint16_t> &points);
+    // longest line followed, 0 for 16 times the number of points to play on
+    void set_max_ply(uint16_t plies);
+    // 0 for no limit
+    void set_node_limit(uint64_t nodes);
+    SolveResult solve(const Board &b);
+
+protected:
+    TranspositionTable tt;
+    std::array<bool, NUM_POINTS> in_region{};
+    bool whole_board = true;
+    uint16_t max_ply = 0;
+    uint16_t default_max_ply = 0;
+    uint64_t node_limit = 0;
+    int16_t horizon_score = 0; // black's score for a line that reaches max_ply
+
+    std::vector<Board> stack;   // stack[ply] is the position after ply moves of the solve
+    std::vector<uint64_t> path; // stone hashes of stack[0..ply], for superko
+    uint64_t nodes = 0;
+    uint64_t truncated = 0;
+    bool stopped = false;
+
+    // scores are from the side to move's point of view
+    int16_t negamax(uint16_t ply, int16_t alpha, int16_t beta, bool passed);
+    // the table key of stack[ply] and the symmetry that maps it to the stored orientation
+    uint64_t position_key(uint16_t ply, bool passed, uint8_t &symmetry) const;
+    bool fills_own_eye(const Board &b, uint16_t idx) const;
+    bool repeats(uint16_t ply) const;
+};
+
+#endif
@@ -0,0 +1,266 @@
+#include "TranspositionTable.h"
+#include "Board.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr uint64_t TT_MAGIC = 0x4c42415453414854; // "THASTABL"
+static constexpr uint32_t TT_VERSION = 1;
+
+// the slots follow at the next cache line
+struct alignas(64) TranspositionTable::FileHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t board_size;
+    uint64_t key_check; // changes whenever the zobrist keys do
+    uint64_t score_check;
+    uint64_t num_slots;
+    uint64_t checksum; // of everything above
+    std::atomic<uint32_t> generation; // shared, so every process ages entries together
+};
+
+static uint64_t mix(uint64_t hash, uint64_t value)
+{
+    hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    return hash * 0xbf58476d1ce4e5b9;
+}
+
+static uint64_t zobrist_check()
+{
+    Board b;
+    b.make_play(Board::coords_to_idx(0, 0));
+    uint8_t symmetry;
+    return b.get_canonical_key(symmetry);
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+{
+    allocate(megabytes);
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes, const std::string &path, uint64_t score_check)
+{
+    if (!map_file(megabytes, path, score_check))
+    {
+        std::cout << "Failed to map file " << path << ", using a table in memory" << '\n';
+        allocate(megabytes);
+    }
+}
+
+TranspositionTable::~TranspositionTable()
+{
+    if (header != nullptr)
+    {
+        munmap(header, mapping_length);
+    }
+}
+
+void TranspositionTable::allocate(size_t megabytes)
+{
+    size_t count = 1;
+    while (count * 2 * sizeof(Slot) <= megabytes * 1024 * 1024)
+    {
+        count *= 2;
+    }
+    allocated = std::make_unique<Slot[]>(count);
+    slots = allocated.get();
+    mask = count - 1;
+    clear();
+}
+
+bool TranspositionTable::map_file(size_t megabytes, const std::string &path, uint64_t score_check)
+{
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                  "atomics in a shared mapping have to be lock free");
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1)
+    {
+        return false;
+    }
+    // held while the header is checked or written, so two processes starting together don't both set it up
+    if (flock(fd, LOCK_EX) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    FileHeader expected{};
+    expected.magic = TT_MAGIC;
+    expected.version = TT_VERSION;
+    expected.board_size = BOARD_SIZE;
+    expected.key_check = zobrist_check();
+    expected.score_check = score_check;
+    auto header_checksum = [](const FileHeader &h)
+    {
+        uint64_t hash = 0;
+        for (uint64_t value : {h.magic, uint64_t(h.version), uint64_t(h.board_size), h.key_check, h.score_check, h.num_slots})
+        {
+            hash = mix(hash, value);
+        }
+        return hash;
+    };
+
+    FileHeader found{};
+    bool valid = false;
+    if (size_t(st.st_size) >= sizeof(FileHeader) && pread(fd, &found, sizeof(FileHeader), 0) == ssize_t(sizeof(FileHeader)))
+    {
+        uint64_t slots_found = found.num_slots;
+        valid = found.magic == expected.magic && found.version == expected.version && found.board_size == expected.board_size &&
+                found.key_check == expected.key_check && found.score_check == expected.score_check &&
+                found.checksum == header_checksum(found) && slots_found != 0 && (slots_found & (slots_found - 1)) == 0 &&
+                sizeof(FileHeader) + slots_found * sizeof(Slot) <= size_t(st.st_size);
+    }
+
+    size_t count;
+    if (valid)
+    {
+        count = found.num_slots;
+    }
+    else
+    {
+        count = 1;
+        while (count * 2 * sizeof(Slot) <= megabytes * 1024 * 1024)
+        {
+            count *= 2;
+        }
+        if (st.st_size > 0)
+        {
+            std::cout << "Rejected transposition table " << path << " (wrong version, board size, keys or scores), starting it over" << '\n';
+        }
+    }
+
+    // never shrunk, another process may still have the old length mapped
+    size_t length = std::max<size_t>(sizeof(FileHeader) + count * sizeof(Slot), st.st_size);
+    if (size_t(st.st_size) < length && ftruncate(fd, length) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    void *mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    header = static_cast<FileHeader *>(mapping);
+    mapping_length = length;
+    slots = reinterpret_cast<Slot *>(static_cast<uint8_t *>(mapping) + sizeof(FileHeader));
+    mask = count - 1;
+    if (!valid)
+    {
+        // the slots first, so the header never vouches for slots that weren't cleared
+        clear();
+        header->num_slots = count;
+        header->generation.store(0, std::memory_order_relaxed);
+        expected.num_slots = count;
+        expected.checksum = header_checksum(expected);
+        header->magic = expected.magic;
+        header->version = expected.version;
+        header->board_size = expected.board_size;
+        header->key_check = expected.key_check;
+        header->score_check = expected.score_check;
+        header->checksum = expected.checksum;
+        msync(mapping, sizeof(FileHeader), MS_SYNC);
+    }
+    generation = header->generation.load(std::memory_order_relaxed);
+    salt = mix(header->checksum, TT_VERSION);
+    close(fd); // releases the lock, the mapping stays
+    return true;
+}
+
+uint64_t TranspositionTable::pack(const TTEntry &entry)
+{
+    // move 16 bits, score 16, depth 8, bound 2, generation 6
+    return uint64_t(entry.move) | uint64_t(uint16_t(entry.score)) << 16 | uint64_t(entry.depth) << 32 |
+           uint64_t(entry.bound) << 40 | uint64_t(entry.generation & 63) << 42;
+}
+
+TTEntry TranspositionTable::unpack(uint64_t data)
+{
+    TTEntry entry;
+    entry.move = data & 0xFFFF;
+    entry.score = int16_t(uint16_t(data >> 16));
+    entry.depth = (data >> 32) & 0xFF;
+    entry.bound = ttBound((data >> 40) & 3);
+    entry.generation = (data >> 42) & 63;
+    return entry;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry &entry) const
+{
+    const Slot &slot = slots[key & mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data ^ salt) != key || data == 0)
+    {
+        return false;
+    }
+    entry = unpack(data);
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, uint16_t move, int16_t score, uint8_t depth, ttBound bound)
+{
+    Slot &slot = slots[key & mask];
+    uint64_t old_data = slot.data.load(std::memory_order_relaxed);
+    uint64_t old_check = slot.check.load(std::memory_order_relaxed);
+    if ((old_check ^ old_data ^ salt) == key && old_data != 0)
+    {
+        TTEntry old = unpack(old_data);
+        if (old.generation == (generation & 63) && old.depth > depth)
+        {
+            return;
+        }
+        // a shallower result without a move shouldn't forget the move we had
+        if (move == 0)
+        {
+            move = old.move;
+        }
+    }
+    uint64_t data = pack(TTEntry{move, score, depth, bound, generation});
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data ^ salt, std::memory_order_relaxed);
+}
+
+void TranspositionTable::new_generation()
+{
+    if (header != nullptr)
+    {
+        generation = header->generation.fetch_add(1, std::memory_order_relaxed) + 1;
+        return;
+    }
+    generation++;
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i <= mask; i++)
+    {
+        slots[i].data.store(0, std::memory_order_relaxed);
+        slots[i].check.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t TranspositionTable::num_slots() const
+{
+    return mask + 1;
+}
+
+bool TranspositionTable::is_mapped() const
+{
+    return header != nullptr;
+}
@@ -0,0 +1,79 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+/* Fixed size hash table of search results keyed by Board::get_canonical_key. Each slot is two 64 bit
+   words, the packed entry and the entry xor'ed with its key, written and read without locks: a slot
+   torn by two threads writing at once no longer xors back to the key and simply reads as a miss.
+   A table can also live in a file mapped into memory, which outlasts the process and is shared by every
+   process that maps it; the same lockless slots work across processes as they do across threads. */
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+enum ttBound
+{
+    TT_NONE = 0,
+    TT_EXACT = 1,
+    TT_LOWER = 2, // the score is at least this, the search failed high
+    TT_UPPER = 3  // the score is at most this, the search failed low
+};
+
+struct TTEntry
+{
+    uint16_t move;
+    int16_t score;
+    uint8_t depth;
+    ttBound bound;
+    uint8_t generation;
+};
+
+class TranspositionTable
+{
+public:
+    // size is rounded down to a power of two slots
+    TranspositionTable(size_t megabytes);
+    // backed by the file at path, created with megabytes worth of slots if it doesn't exist yet, otherwise
+    // keeping the size it has. score_check stands for whatever the scores depend on beyond the position,
+    // e.g. the evaluator weights; a file written with other keys, version or score_check, or with a
+    // broken header, is wiped. Falls back to an ordinary table if the file can't be mapped
+    TranspositionTable(size_t megabytes, const std::string &path, uint64_t score_check);
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    bool probe(uint64_t key, TTEntry &entry) const;
+    // keeps the existing entry if it is from this generation and searched deeper
+    void store(uint64_t key, uint16_t move, int16_t score, uint8_t depth, ttBound bound);
+    // called once per search, entries from older searches become the first to be replaced
+    void new_generation();
+    void clear();
+    size_t num_slots() const;
+    bool is_mapped() const;
+
+protected:
+    struct Slot
+    {
+        std::atomic<uint64_t> check; // key ^ data
+        std::atomic<uint64_t> data;
+    };
+
+    struct FileHeader;
+
+    Slot *slots = nullptr;
+    std::unique_ptr<Slot[]> allocated;
+    FileHeader *header = nullptr; // the start of the mapping for a file backed table
+    size_t mapping_length = 0;
+    size_t mask = 0;
+    uint8_t generation = 0;
+    // folded into every check word of a file backed table, so entries written under another version or
+    // score_check never match
+    uint64_t salt = 0;
+
+    void allocate(size_t megabytes);
+    bool map_file(size_t megabytes, const std::string &path, uint64_t score_check);
+
+    static uint64_t pack(const TTEntry &entry);
+    static TTEntry unpack(uint64_t data);
+};
+
+#endif
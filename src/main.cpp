@@ -5,6 +5,11 @@
 #include <iostream>
 #include "Agent.h"
 #include "SGFFile.h"
+#include "PerfCounters.h"
+#include "GTPEngine.h"
+#include "GameLog.h"
+#include <algorithm>
+#include <cstring>
 
 // int main()
 // {
@@ -12,19 +17,7 @@
 //     return 0;
 // }
 
-// void stress_test()
-// {
-//     for (int i = 0; i < 10000; i++)
-//     {
-//         Board b = Board();
-//         for (int j = 0; j < 1000; j++)
-//         {
-//             b.make_play(rand() % BOARD_SIZE, rand() % BOARD_SIZE);
-//         }
-//     }
-// }
-
-int main()
+int main(int argc, char **argv)
 {
     //     srand(time(NULL));
 
@@ -52,6 +45,104 @@ int main()
 
     //     //     std::cout << "Hello anyone there?" << std::endl;
     //     //     return 0;
+    bool gtp = false;
+    size_t hash_megabytes = 64;
+    std::string hash_path;
+    uint8_t depth = 3;
+    logLevel verbosity = LOG_BOARDS;
+    std::string log_path;
+    std::string sgf_path;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--gtp"))
+        {
+            gtp = true;
+        }
+        else if (!strcmp(argv[i], "--hash") && i + 1 < argc)
+        {
+            hash_megabytes = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--hash-file") && i + 1 < argc)
+        {
+            hash_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--depth") && i + 1 < argc)
+        {
+            depth = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--verbosity") && i + 1 < argc)
+        {
+            verbosity = logLevel(std::min(3UL, std::strtoul(argv[++i], nullptr, 10)));
+        }
+        else if (!strcmp(argv[i], "--log") && i + 1 < argc)
+        {
+            log_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--sgf") && i + 1 < argc)
+        {
+            sgf_path = argv[++i];
+        }
+        else
+        {
+            printf("usage: %s [--gtp] [--hash MB] [--hash-file FILE] [--depth N] [--verbosity 0-3] [--log FILE] [--sgf FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::shared_ptr<OpeningBook> book = std::make_shared<OpeningBook>();
+    bool has_book = book->load(path_to_book);
+    std::shared_ptr<PatternTable> patterns = std::make_shared<PatternTable>();
+    bool has_patterns = patterns->load(path_to_patterns);
+    std::shared_ptr<Evaluator> evaluator = std::make_shared<Evaluator>();
+    bool has_weights = evaluator->load(path_to_weights);
+
+    if (gtp)
+    {
+        // stdout belongs to the protocol, GTPEngine keeps the search state warm between commands
+        GTPEngine engine(hash_megabytes, depth);
+        if (has_book)
+        {
+            engine.set_book(book);
+        }
+        if (has_patterns)
+        {
+            engine.set_patterns(patterns);
+        }
+        if (has_weights)
+        {
+            engine.set_evaluator(evaluator);
+        }
+        if (!hash_path.empty())
+        {
+            // engines started with the same file share one table, and find it warm after a restart
+            engine.set_transposition_table(std::make_shared<TranspositionTable>(hash_megabytes, hash_path, has_weights ? evaluator->fingerprint() : 0));
+        }
+        engine.run(std::cin, std::cout);
+        return 0;
+    }
+
     Agent a = Agent();
-    a.play(3, 1000);
+    if (has_book)
+    {
+        a.set_book(book);
+    }
+    if (has_patterns)
+    {
+        a.set_patterns(patterns);
+    }
+    if (has_weights)
+    {
+        a.set_evaluator(evaluator);
+    }
+    {
+        // the log is closed, and everything in it written, before the reports below
+        GameLog log(verbosity, log_path);
+        a.play(depth, 1000, log, sgf_path);
+    }
+#if SEARCH_STATS
+    write_chrome_trace("search_trace.json");
+#endif
+#if PERF_COUNTERS
+    print_perf_report();
+#endif
 }
\ No newline at end of file
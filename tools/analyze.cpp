@@ -0,0 +1,452 @@
+/* Analyses a batch of unrelated positions on a fixed pool of searching threads. Each input line is one
+   job: an SGF file or a list of GTP moves from the empty board, optionally preceded by budgets that
+   override the defaults for that job. Lines are handed to the workers through a bounded queue, so
+   memory stays flat however long the input is, and results are printed as soon as each job finishes.
+   With --progress every finished iteration is reported as a comment line while the job is running.
+   With --all-moves every legal move of a position is scored instead, one position at a time with the
+   root moves spread over the threads, optionally followed by a heatmap of the board.
+   With --hash-file the workers share one transposition table kept in that file instead of one each,
+   and it isn't cleared between jobs, so a restarted run, or several runs at once, start from what the
+   searches before them found.
+   With --trace every search iteration, and with --all-moves every root move, is written to FILE as a
+   chrome://tracing / perfetto timeline per thread once all the workers are done. The events are only
+   recorded in a build with SEARCH_STATS, make build/stats/analyze.
+
+   nodes=20000 time=0.5 depth=8 move=120 games/some_game.sgf
+   D4 K10 pass C3 */
+#include "GTPEngine.h"
+#include "GameRecord.h"
+#include "RootAnalysis.h"
+#include "WorkQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+static constexpr uint8_t MAX_BUDGET_DEPTH = 32;
+
+struct AnalysisJob
+{
+    uint32_t number; // input line
+    std::string line;
+};
+
+struct AnalysisBudget
+{
+    uint8_t depth = 3;
+    double seconds = 0;
+    uint64_t nodes = 0;
+};
+
+struct AnalysisTotals
+{
+    uint32_t jobs = 0;
+    uint32_t errors = 0;
+    uint64_t nodes = 0;
+};
+
+// the position of an SGF game after move_limit moves (all of them when it is 0), setup stones included
+static bool load_sgf_position(const std::string &path, uint32_t move_limit, Board &b, std::string &error)
+{
+    SGFFile file(path);
+    GameRecord record;
+    if (!file.is_valid())
+    {
+        error = "Failed to open file " + path;
+        return false;
+    }
+    if (!load_record(file, record))
+    {
+        error = "not a " + std::to_string(BOARD_SIZE) + "x" + std::to_string(BOARD_SIZE) + " game";
+        return false;
+    }
+    uint16_t num_moves = move_limit == 0 ? record.moves.size() : std::min<size_t>(move_limit, record.moves.size());
+    uint16_t played;
+    if (!load_position(record, num_moves, b, played))
+    {
+        error = "illegal move " + std::to_string(played + 1);
+        return false;
+    }
+    return true;
+}
+
+// fills in the position and budget of a job line, returns false with a message if it can't be read
+static bool parse_job(const std::string &line, Board &b, AnalysisBudget &budget, std::string &source, std::string &error)
+{
+    b = Board();
+    std::istringstream words(line);
+    std::vector<std::string> moves;
+    uint32_t move_limit = 0;
+    bool depth_given = false;
+    bool limit_given = false;
+    for (std::string word; words >> word;)
+    {
+        size_t equals = word.find('=');
+        std::string key = word.substr(0, equals);
+        const char *value = equals == std::string::npos ? "" : word.c_str() + equals + 1;
+        if (equals == std::string::npos)
+        {
+            moves.push_back(word);
+        }
+        else if (key == "nodes")
+        {
+            budget.nodes = std::strtoull(value, nullptr, 10);
+            limit_given = true;
+        }
+        else if (key == "time")
+        {
+            budget.seconds = std::strtod(value, nullptr);
+            limit_given = true;
+        }
+        else if (key == "depth")
+        {
+            budget.depth = std::strtoul(value, nullptr, 10);
+            depth_given = true;
+        }
+        else if (key == "move")
+        {
+            move_limit = std::strtoul(value, nullptr, 10);
+        }
+        else
+        {
+            error = "unknown setting " + word;
+            return false;
+        }
+    }
+    if (limit_given && !depth_given)
+    {
+        budget.depth = MAX_BUDGET_DEPTH;
+    }
+    if (budget.depth == 0)
+    {
+        error = "depth has to be at least 1";
+        return false;
+    }
+
+    if (moves.size() == 1 && std::filesystem::path(moves[0]).extension() == ".sgf")
+    {
+        source = moves[0];
+        return load_sgf_position(moves[0], move_limit, b, error);
+    }
+    for (uint32_t i = 0; i < moves.size(); i++)
+    {
+        uint16_t idx;
+        if (!parse_gtp_vertex(moves[i], idx))
+        {
+            error = "bad vertex " + moves[i];
+            return false;
+        }
+        if (!b.make_play(idx))
+        {
+            error = "illegal move " + std::to_string(i + 1) + " " + moves[i];
+            return false;
+        }
+    }
+    source = moves.empty() ? "empty board" : std::to_string(moves.size()) + " moves";
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    std::string input_path;
+    uint16_t num_threads = 0;
+    size_t queue_size = 0;
+    size_t hash_megabytes = 16;
+    std::string hash_path;
+    bool use_book = false;
+    bool use_patterns = false;
+    std::string weights_path;
+    std::string trace_path;
+    bool all_moves = false;
+    bool heatmap = false;
+    bool progress = false;
+    AnalysisBudget defaults;
+    bool depth_given = false;
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--input") && has_value)
+        {
+            input_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--threads") && has_value)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--queue") && has_value)
+        {
+            queue_size = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--hash") && has_value)
+        {
+            hash_megabytes = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--hash-file") && has_value)
+        {
+            hash_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--depth") && has_value)
+        {
+            defaults.depth = std::strtoul(argv[++i], nullptr, 10);
+            depth_given = true;
+        }
+        else if (!strcmp(argv[i], "--time") && has_value)
+        {
+            defaults.seconds = std::strtod(argv[++i], nullptr);
+        }
+        else if (!strcmp(argv[i], "--nodes") && has_value)
+        {
+            defaults.nodes = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--all-moves"))
+        {
+            all_moves = true;
+        }
+        else if (!strcmp(argv[i], "--heatmap"))
+        {
+            all_moves = true;
+            heatmap = true;
+        }
+        else if (!strcmp(argv[i], "--progress"))
+        {
+            progress = true;
+        }
+        else if (!strcmp(argv[i], "--book"))
+        {
+            use_book = true;
+        }
+        else if (!strcmp(argv[i], "--patterns"))
+        {
+            use_patterns = true;
+        }
+        else if (!strcmp(argv[i], "--weights") && has_value)
+        {
+            weights_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--trace") && has_value)
+        {
+            trace_path = argv[++i];
+            if (!SEARCH_STATS)
+            {
+                printf("--trace needs a build with SEARCH_STATS, make build/stats/analyze\n");
+                return 1;
+            }
+        }
+        else
+        {
+            printf("usage: %s [--input FILE] [--threads N] [--queue N] [--hash MB] [--hash-file FILE] [--depth N] [--time S] [--nodes N] [--progress] [--all-moves] [--heatmap] [--book] [--patterns] [--weights FILE] [--trace FILE]\n", argv[0]);
+            printf("reads jobs from stdin without --input, one per line: [nodes=N] [time=S] [depth=N] [move=N] (FILE.sgf | MOVES...)\n");
+            return 1;
+        }
+    }
+    // with a time or node budget the depth is only a cap
+    if ((defaults.seconds > 0 || defaults.nodes > 0) && !depth_given)
+    {
+        defaults.depth = MAX_BUDGET_DEPTH;
+    }
+    num_threads = num_threads ? num_threads : std::max(1U, std::thread::hardware_concurrency());
+    // root move analysis already keeps every thread busy on one position
+    uint16_t num_workers = all_moves ? 1 : num_threads;
+    queue_size = queue_size ? queue_size : 2 * num_workers;
+
+    std::ifstream input_file;
+    if (!input_path.empty())
+    {
+        input_file.open(input_path);
+        if (!input_file)
+        {
+            std::cout << "Failed to open file " << input_path << '\n';
+            return 1;
+        }
+    }
+    std::istream &input = input_path.empty() ? std::cin : input_file;
+
+    std::shared_ptr<OpeningBook> book = std::make_shared<OpeningBook>();
+    if (use_book && !book->load(path_to_book))
+    {
+        printf("Failed to load opening book %s\n", path_to_book.c_str());
+        return 1;
+    }
+    std::shared_ptr<PatternTable> patterns = std::make_shared<PatternTable>();
+    if (use_patterns && !patterns->load(path_to_patterns))
+    {
+        printf("Failed to load pattern table %s\n", path_to_patterns.c_str());
+        return 1;
+    }
+    std::shared_ptr<Evaluator> evaluator;
+    if (!weights_path.empty())
+    {
+        evaluator = std::make_shared<Evaluator>();
+        if (!evaluator->load(weights_path))
+        {
+            printf("Failed to load evaluation weights %s\n", weights_path.c_str());
+            return 1;
+        }
+    }
+
+    std::shared_ptr<TranspositionTable> shared_tt;
+    if (!hash_path.empty())
+    {
+        shared_tt = std::make_shared<TranspositionTable>(std::max<size_t>(hash_megabytes, 1), hash_path, evaluator ? evaluator->fingerprint() : 0);
+        if (!shared_tt->is_mapped())
+        {
+            return 1;
+        }
+    }
+
+    if (all_moves)
+    {
+        printf("# line\tmove\tscore\tnodes\tpv\n");
+    }
+    else
+    {
+        printf("# line\tmove\tscore\tdepth\tnodes\tms\tposition\n");
+    }
+    fflush(stdout);
+    WorkQueue<AnalysisJob> queue(queue_size);
+    std::mutex mutex;
+    AnalysisTotals totals;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (uint16_t t = 0; t < num_workers; t++)
+    {
+        workers.emplace_back([&]()
+                             {
+            // everything a job needs is set up once per thread and reused
+            Agent agent;
+            std::shared_ptr<TranspositionTable> tt = shared_tt;
+            if (!tt && hash_megabytes)
+            {
+                tt = std::make_shared<TranspositionTable>(hash_megabytes);
+            }
+            agent.set_transposition_table(tt);
+            if (use_book)
+            {
+                agent.set_book(book);
+            }
+            if (use_patterns)
+            {
+                agent.set_patterns(patterns);
+            }
+            agent.set_evaluator(evaluator);
+            Board b;
+            std::ostringstream result;
+            for (AnalysisJob job; queue.pop(job);)
+            {
+                AnalysisBudget budget = defaults;
+                std::string source;
+                std::string error;
+                result.str("");
+                uint64_t nodes = 0;
+                bool parsed = parse_job(job.line, b, budget, source, error);
+                if (parsed && all_moves && (budget.seconds > 0 || budget.nodes > 0))
+                {
+                    parsed = false;
+                    error = "all moves analysis only takes a depth";
+                }
+                if (parsed && all_moves)
+                {
+                    if (tt && !shared_tt)
+                    {
+                        tt->clear();
+                    }
+                    std::vector<MoveAnalysis> moves = analyse_root_moves(b, budget.depth, num_threads, tt, use_patterns ? patterns : nullptr, evaluator);
+                    for (const MoveAnalysis &analysis : moves)
+                    {
+                        result << job.number << '\t' << gtp_vertex(analysis.move) << '\t' << analysis.score << '\t' << analysis.nodes << '\t';
+                        for (size_t i = 0; i < analysis.pv.size(); i++)
+                        {
+                            result << (i ? " " : "") << gtp_vertex(analysis.pv[i]);
+                        }
+                        result << '\n';
+                        nodes += analysis.nodes;
+                    }
+                    if (moves.empty())
+                    {
+                        result << job.number << "\tpass\t" << b.score() << "\t0\tpass\n";
+                    }
+                    if (heatmap)
+                    {
+                        std::istringstream rows(format_heatmap(b, moves));
+                        for (std::string row; std::getline(rows, row);)
+                        {
+                            result << "# " << row << '\n';
+                        }
+                    }
+                }
+                else if (parsed)
+                {
+                    result << job.number << '\t';
+                    // positions are unrelated, so entries from the last job would only get in the way; a shared
+                    // table is kept for the sake of the jobs that do repeat
+                    if (tt && !shared_tt)
+                    {
+                        tt->clear();
+                    }
+                    SearchUpdate best{};
+                    for (const SearchUpdate &update : agent.iterate(b, budget.depth, budget.seconds, budget.nodes))
+                    {
+                        best = update;
+                        if (progress)
+                        {
+                            std::string pv;
+                            for (uint16_t move : update.pv)
+                            {
+                                pv += " " + gtp_vertex(move);
+                            }
+                            std::lock_guard<std::mutex> lock(mutex);
+                            printf("# %u depth %d score %d nodes %lu ms %.0f pv%s\n", job.number, int(update.depth), update.score, update.nodes,
+                                   1000 * update.seconds, pv.c_str());
+                            fflush(stdout);
+                        }
+                    }
+                    nodes = best.nodes;
+                    result << gtp_vertex(best.move) << '\t' << best.score << '\t' << int(best.depth) << '\t' << nodes << '\t'
+                           << uint64_t(1000 * best.seconds) << '\t' << source << '\n';
+                }
+                else
+                {
+                    result << job.number << "\terror\t" << error << '\n';
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                totals.jobs++;
+                totals.errors += !error.empty();
+                totals.nodes += nodes;
+                printf("%s", result.str().c_str());
+                fflush(stdout);
+            } });
+    }
+
+    uint32_t number = 0;
+    for (std::string line; std::getline(input, line);)
+    {
+        number++;
+        std::string stripped = line.substr(0, line.find('#'));
+        if (stripped.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+        // blocks while every worker is busy and the queue is full
+        queue.push(AnalysisJob{number, stripped});
+    }
+    queue.close();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    if (!trace_path.empty())
+    {
+        write_chrome_trace(trace_path);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "%u jobs (%u errors) in %.2fs on %u threads: %.1f jobs/s, %.0f nodes/s\n", totals.jobs, totals.errors, seconds,
+            num_threads, totals.jobs / seconds, totals.nodes / seconds);
+    return 0;
+}
@@ -0,0 +1,370 @@
+/* Benchmarks the Board hot paths and the alpha-beta search on an optimised build.
+   Every workload is generated from a fixed seed so numbers are comparable across commits.
+   Results are printed as a table and optionally appended as one JSON line per run to a file. */
+#include "Agent.h"
+#include "Board.h"
+#include "PerfCounters.h"
+#include "SearchTree.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+struct BenchConfig
+{
+    uint32_t seed = 1;
+    uint32_t games = 200;
+    uint32_t warmup = 1;
+    uint32_t reps = 5;
+    uint8_t max_depth = 3;
+    std::string json_path = "";
+    std::string label = "";
+};
+
+struct Sample
+{
+    uint64_t ops;
+    double seconds;
+};
+
+struct BenchResult
+{
+    std::string name;
+    std::string unit;
+    uint32_t reps;
+    uint64_t ops; // work done per repetition
+    double rate_mean;
+    double rate_stddev;
+    double rate_min;
+    double rate_max;
+    double seconds_mean;
+    double seconds_stddev;
+};
+
+struct FixedPosition
+{
+    const char *name;
+    uint16_t plies;
+};
+
+// positions are random games from a constant seed cut off at these move numbers
+static constexpr uint32_t POSITION_SEED = 20240601;
+static const std::array<FixedPosition, 4> fixed_positions = {{{"empty", 0},
+                                                               {"opening", BOARD_SIZE},
+                                                               {"middlegame", BOARD_SIZE * BOARD_SIZE / 3},
+                                                               {"endgame", BOARD_SIZE * BOARD_SIZE * 4 / 5}}};
+
+template <typename F>
+BenchResult run_bench(const std::string &name, const std::string &unit, const BenchConfig &config, F body)
+{
+    for (uint32_t i = 0; i < config.warmup; i++)
+    {
+        body();
+    }
+
+    std::vector<Sample> samples;
+    for (uint32_t i = 0; i < config.reps; i++)
+    {
+        samples.push_back(body());
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.unit = unit;
+    result.reps = config.reps;
+    result.ops = samples.empty() ? 0 : samples[0].ops;
+    result.rate_min = INFINITY;
+    result.rate_max = 0;
+
+    double rate_sum = 0;
+    double seconds_sum = 0;
+    for (const Sample &s : samples)
+    {
+        double rate = s.seconds > 0 ? double(s.ops) / s.seconds : 0;
+        rate_sum += rate;
+        seconds_sum += s.seconds;
+        result.rate_min = std::min(result.rate_min, rate);
+        result.rate_max = std::max(result.rate_max, rate);
+    }
+    uint32_t n = samples.size();
+    result.rate_mean = n ? rate_sum / n : 0;
+    result.seconds_mean = n ? seconds_sum / n : 0;
+
+    // sample standard deviation
+    double rate_var = 0;
+    double seconds_var = 0;
+    for (const Sample &s : samples)
+    {
+        double rate = s.seconds > 0 ? double(s.ops) / s.seconds : 0;
+        rate_var += (rate - result.rate_mean) * (rate - result.rate_mean);
+        seconds_var += (s.seconds - result.seconds_mean) * (s.seconds - result.seconds_mean);
+    }
+    result.rate_stddev = n > 1 ? std::sqrt(rate_var / (n - 1)) : 0;
+    result.seconds_stddev = n > 1 ? std::sqrt(seconds_var / (n - 1)) : 0;
+    if (n == 0)
+    {
+        result.rate_min = 0;
+    }
+    return result;
+}
+
+template <typename F>
+double time_seconds(F body)
+{
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+std::vector<uint16_t> random_game(uint32_t seed, uint16_t max_plies)
+{
+    // uses raw mt19937 output so the games are identical on every standard library
+    std::mt19937 rng(seed);
+    Board b;
+    std::array<uint16_t, NUM_POINTS> legal{};
+    std::vector<uint16_t> moves;
+    bool passed = false;
+    while (moves.size() < max_plies)
+    {
+        uint16_t num_legal = b.get_legal_moves(legal);
+        uint16_t move = num_legal ? legal[rng() % num_legal] : PASS;
+        if (move == PASS && passed)
+        {
+            break;
+        }
+        passed = move == PASS;
+        b.make_play(move);
+        moves.push_back(move);
+    }
+    return moves;
+}
+
+Board replay(const std::vector<uint16_t> &moves, uint16_t plies)
+{
+    Board b;
+    for (uint16_t i = 0; i < plies && i < moves.size(); i++)
+    {
+        b.make_play(moves[i]);
+    }
+    return b;
+}
+
+void print_result(const BenchResult &r)
+{
+    printf("%-28s %14.0f %-10s +- %5.1f%%   (min %.0f, max %.0f, %.4fs +- %.4fs)\n",
+           r.name.c_str(), r.rate_mean, r.unit.c_str(),
+           r.rate_mean > 0 ? 100.0 * r.rate_stddev / r.rate_mean : 0.0,
+           r.rate_min, r.rate_max, r.seconds_mean, r.seconds_stddev);
+}
+
+void write_json(const BenchConfig &config, const std::vector<BenchResult> &results)
+{
+    std::ofstream out(config.json_path, std::ios::app);
+    if (!out.is_open())
+    {
+        std::cout << "Failed to open file " << config.json_path << '\n';
+        return;
+    }
+    out.precision(10);
+    out << "{\"label\":\"" << config.label << "\",\"board_size\":" << BOARD_SIZE
+        << ",\"seed\":" << config.seed << ",\"games\":" << config.games
+        << ",\"warmup\":" << config.warmup << ",\"reps\":" << config.reps
+        << ",\"timestamp\":" << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()
+        << ",\"results\":[";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+        out << (i ? "," : "") << "{\"name\":\"" << r.name << "\",\"unit\":\"" << r.unit
+            << "\",\"ops\":" << r.ops << ",\"rate_mean\":" << r.rate_mean
+            << ",\"rate_stddev\":" << r.rate_stddev << ",\"rate_min\":" << r.rate_min
+            << ",\"rate_max\":" << r.rate_max << ",\"seconds_mean\":" << r.seconds_mean
+            << ",\"seconds_stddev\":" << r.seconds_stddev << "}";
+    }
+    out << "]}\n";
+}
+
+bool parse_args(int argc, char **argv, BenchConfig &config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--seed") && has_value)
+        {
+            config.seed = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--games") && has_value)
+        {
+            config.games = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--warmup") && has_value)
+        {
+            config.warmup = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--reps") && has_value)
+        {
+            config.reps = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--depth") && has_value)
+        {
+            config.max_depth = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--json") && has_value)
+        {
+            config.json_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--label") && has_value)
+        {
+            config.label = argv[++i];
+        }
+        else
+        {
+            printf("usage: %s [--seed N] [--games N] [--warmup N] [--reps N] [--depth N] [--json FILE] [--label STR]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    BenchConfig config;
+    if (!parse_args(argc, argv, config))
+    {
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+
+    // seeded random games for make_play throughput
+    std::vector<std::vector<uint16_t>> games;
+    uint64_t total_plies = 0;
+    for (uint32_t g = 0; g < config.games; g++)
+    {
+        games.push_back(random_game(config.seed + g, 3 * BOARD_SIZE * BOARD_SIZE));
+        total_plies += games.back().size();
+    }
+
+    results.push_back(run_bench("make_play/random_games", "plays/s", config, [&]()
+                                {
+        // construct boards up front so the timing only covers make_play
+        std::vector<Board> boards(games.size());
+        double seconds = time_seconds([&]()
+                                      {
+            for (size_t g = 0; g < games.size(); g++)
+            {
+                for (uint16_t move : games[g])
+                {
+                    boards[g].make_play(move);
+                }
+            } });
+        return Sample{total_plies, seconds}; }));
+    print_result(results.back());
+
+    std::vector<Board> positions;
+    std::vector<uint16_t> position_moves = random_game(POSITION_SEED, 3 * BOARD_SIZE * BOARD_SIZE);
+    for (const FixedPosition &p : fixed_positions)
+    {
+        positions.push_back(replay(position_moves, p.plies));
+    }
+
+    const uint32_t calls_per_rep = 2000;
+    for (size_t p = 0; p < positions.size(); p++)
+    {
+        const Board &b = positions[p];
+        results.push_back(run_bench(std::string("legal_moves/") + fixed_positions[p].name, "gens/s", config, [&]()
+                                    {
+            std::array<uint16_t, NUM_POINTS> legal{};
+            volatile uint16_t sink = 0;
+            double seconds = time_seconds([&]()
+                                          {
+                for (uint32_t i = 0; i < calls_per_rep; i++)
+                {
+                    sink = sink + b.get_legal_moves(legal);
+                } });
+            return Sample{calls_per_rep, seconds}; }));
+        print_result(results.back());
+    }
+
+    for (size_t p = 0; p < positions.size(); p++)
+    {
+        const Board &b = positions[p];
+        results.push_back(run_bench(std::string("score/") + fixed_positions[p].name, "scores/s", config, [&]()
+                                    {
+            volatile int16_t sink = 0;
+            uint32_t calls = calls_per_rep * 20;
+            double seconds = time_seconds([&]()
+                                          {
+                for (uint32_t i = 0; i < calls; i++)
+                {
+                    sink = sink + b.score();
+                } });
+            return Sample{calls, seconds}; }));
+        print_result(results.back());
+    }
+
+    for (size_t p = 0; p < positions.size(); p++)
+    {
+        const Board &b = positions[p];
+        for (uint8_t depth = 1; depth <= config.max_depth; depth++)
+        {
+            // time-to-depth is the seconds column, nodes/s the rate column
+            results.push_back(run_bench(std::string("alphabeta/") + fixed_positions[p].name + "/d" + std::to_string(depth), "nodes/s", config, [&]()
+                                        {
+                Agent a;
+                double seconds = time_seconds([&]()
+                                              { a.get_best_move(b, depth); });
+                return Sample{a.get_node_count(), seconds}; }));
+            print_result(results.back());
+        }
+    }
+
+    // tree storage, breadth first from the middlegame until the arena is full; every node is expanded
+    // with the middlegame's moves so the numbers are about the tree rather than the board
+    const Board &tree_position = positions[2];
+    SearchTree tree(32);
+    std::vector<uint32_t> frontier;
+    auto fill_tree = [&]()
+    {
+        tree.reset(tree_position);
+        frontier.assign(1, tree.get_root());
+        for (size_t f = 0; f < frontier.size() && tree.expand(frontier[f], tree_position); f++)
+        {
+            for (uint32_t c = 0; c < tree[frontier[f]].num_children; c++)
+            {
+                frontier.push_back(tree[frontier[f]].first_child + c);
+            }
+        }
+    };
+    results.push_back(run_bench("tree/expand", "nodes/s", config, [&]()
+                                {
+        double seconds = time_seconds(fill_tree);
+        return Sample{tree.size(), seconds}; }));
+    print_result(results.back());
+    results.push_back(run_bench("tree/reroot", "nodes/s", config, [&]()
+                                {
+        fill_tree();
+        uint32_t first = tree[tree.get_root()].first_child;
+        std::vector<uint16_t> moves = {tree[first].move, tree[tree[first].first_child].move};
+        double seconds = time_seconds([&]()
+                                      { tree.reroot(moves, tree_position); });
+        return Sample{tree.size(), seconds}; }));
+    print_result(results.back());
+
+    if (config.json_path.length())
+    {
+        write_json(config, results);
+    }
+#if PERF_COUNTERS
+    printf("\n");
+    print_perf_report();
+#endif
+    return 0;
+}
@@ -0,0 +1,55 @@
+/* Builds an opening book (see OpeningBook.h) from a directory of SGF files or a .sga archive.
+   Only games on BOARD_SIZE boards without setup stones are used. */
+#include "GameRecord.h"
+#include "OpeningBook.h"
+
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char **argv)
+{
+    std::string games = path_to_games;
+    std::string output = path_to_book;
+    uint16_t num_threads = 0;
+    uint16_t max_plies = 30;
+    uint32_t min_plays = 5;
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--threads") && has_value)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--plies") && has_value)
+        {
+            max_plies = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--min-plays") && has_value)
+        {
+            min_plays = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "-o") && has_value)
+        {
+            output = argv[++i];
+        }
+        else if (argv[i][0] != '-')
+        {
+            games = argv[i];
+        }
+        else
+        {
+            printf("usage: %s [games directory or archive.sga] [-o book] [--plies N] [--min-plays N] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    BookBuilder builder = scan_records<BookBuilder>(games, num_threads, [max_plies](const GameRecord &record, BookBuilder &thread_builder)
+                                                    { thread_builder.add_game(record, max_plies); });
+    int64_t entries = builder.write(output, min_plays);
+    if (entries < 0)
+    {
+        return 1;
+    }
+    printf("%lu positions seen, wrote %ld book entries to %s\n", (unsigned long)builder.positions.size(), (long)entries, output.c_str());
+    return 0;
+}
@@ -0,0 +1,30 @@
+/* Prints the average move number at which each point of the board gets played over a directory of SGF files
+   or a .sga game archive. */
+#include "SGFFile.h"
+
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char **argv)
+{
+    std::string path = path_to_games;
+    uint16_t num_threads = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argv[i][0] != '-')
+        {
+            path = argv[i];
+        }
+        else
+        {
+            printf("usage: %s [games directory or archive.sga] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+    search_files(path, num_threads);
+    return 0;
+}
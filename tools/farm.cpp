@@ -0,0 +1,565 @@
+/* Self-play farm: plays a match like the match tool, but on worker processes instead of threads, so a
+   crash only costs the game it happened in. The coordinator starts the workers by running this binary
+   again with --worker and talks to them over a Unix domain socket: each worker gets the two agent
+   settings once, then one job at a time (game number, seed, random plies and an opening) and answers
+   with a compact binary result. A worker that dies or hangs up has its game handed to another one and
+   is replaced, up to --max-restarts times. The match log, SGF files and summary are those of match.
+
+   farm --first a:depth=3 --second b:depth=2,hash=16 --workers 8 --games 400 --openings openings.txt */
+#include "GTPEngine.h"
+#include "GameLog.h"
+#include "Match.h"
+#include "SGFWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// the first byte of every message, sequenced packets keep one message per recv
+enum farmMessage : uint8_t
+{
+    FARM_HELLO = 1,   // worker to coordinator, its pid
+    FARM_CONFIGS = 2, // the two agent settings, one per line
+    FARM_JOB = 3,
+    FARM_RESULT = 4,  // a FarmResult and its moves
+    FARM_STOP = 5
+};
+
+static constexpr uint16_t MAX_OPENING = 64;
+static constexpr size_t MAX_MESSAGE = 16384;
+
+#pragma pack(push, 1)
+struct FarmJob
+{
+    uint32_t number;
+    uint32_t seed;
+    uint16_t random_plies;
+    uint16_t opening_length;
+    uint16_t opening[MAX_OPENING];
+};
+
+struct FarmResult
+{
+    uint32_t number;
+    uint32_t seed;
+    uint8_t first_is_black;
+    uint8_t reserved;
+    uint16_t num_moves; // followed by this many moves
+    float margin;
+    float think_seconds[2];
+    uint32_t searched_moves[2];
+};
+#pragma pack(pop)
+
+struct FarmWorker
+{
+    pid_t pid;
+    int fd = -1; // -1 until it has said hello
+    bool busy = false;
+    FarmJob job;
+};
+
+static bool send_message(int fd, farmMessage type, const void *payload, size_t size)
+{
+    iovec parts[2] = {{&type, 1}, {const_cast<void *>(payload), size}};
+    msghdr message{};
+    message.msg_iov = parts;
+    message.msg_iovlen = 2;
+    // a worker that has just died shouldn't take the coordinator with it
+    return sendmsg(fd, &message, MSG_NOSIGNAL) == ssize_t(1 + size);
+}
+
+static bool socket_address(const std::string &path, sockaddr_un &address)
+{
+    address = sockaddr_un{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        return false;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+static int run_worker(const std::string &socket_path)
+{
+    sockaddr_un address;
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (fd == -1 || !socket_address(socket_path, address) || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        std::cout << "Failed to connect to " << socket_path << '\n';
+        return 1;
+    }
+    uint32_t pid = getpid();
+    send_message(fd, FARM_HELLO, &pid, sizeof(pid));
+
+    std::shared_ptr<OpeningBook> book = std::make_shared<OpeningBook>();
+    std::shared_ptr<PatternTable> patterns = std::make_shared<PatternTable>();
+    std::unique_ptr<MatchPlayer> players[2];
+    std::vector<uint8_t> message(MAX_MESSAGE);
+    std::vector<uint8_t> reply;
+    while (true)
+    {
+        ssize_t size = recv(fd, message.data(), message.size(), 0);
+        if (size <= 0 || message[0] == FARM_STOP)
+        {
+            break;
+        }
+        if (message[0] == FARM_CONFIGS)
+        {
+            std::istringstream lines(std::string(message.begin() + 1, message.begin() + size));
+            AgentConfig configs[2];
+            for (AgentConfig &config : configs)
+            {
+                std::string spec;
+                std::getline(lines, spec);
+                parse_agent_config(spec, config);
+            }
+            // the coordinator has already checked that these load
+            if ((configs[0].book || configs[1].book) && !book->is_loaded())
+            {
+                book->load(path_to_book);
+            }
+            if ((configs[0].patterns || configs[1].patterns) && !patterns->is_loaded())
+            {
+                patterns->load(path_to_patterns);
+            }
+            for (int p = 0; p < 2; p++)
+            {
+                players[p] = std::make_unique<MatchPlayer>(configs[p], book, patterns);
+            }
+        }
+        else if (message[0] == FARM_JOB && size == 1 + sizeof(FarmJob) && players[0])
+        {
+            FarmJob job;
+            memcpy(&job, message.data() + 1, sizeof(job));
+            std::vector<uint16_t> opening(job.opening, job.opening + std::min(job.opening_length, MAX_OPENING));
+            MatchGame game = play_match_game(*players[0], *players[1], job.number, job.seed, job.random_plies, opening);
+
+            FarmResult result{job.number, job.seed, game.first_is_black, 0, uint16_t(game.moves.size()), game.margin,
+                              {float(game.think_seconds[0]), float(game.think_seconds[1])}, {game.searched_moves[0], game.searched_moves[1]}};
+            reply.resize(sizeof(result) + game.moves.size() * sizeof(uint16_t));
+            memcpy(reply.data(), &result, sizeof(result));
+            memcpy(reply.data() + sizeof(result), game.moves.data(), game.moves.size() * sizeof(uint16_t));
+            if (!send_message(fd, FARM_RESULT, reply.data(), reply.size()))
+            {
+                break;
+            }
+        }
+    }
+    close(fd);
+    return 0;
+}
+
+static pid_t spawn_worker(const std::string &socket_path)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        execl("/proc/self/exe", "farm", "--worker", socket_path.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    return pid;
+}
+
+// one line of GTP moves per opening, blank lines and # comments skipped; every opening has to be legal
+static bool load_openings(const std::string &path, std::vector<std::vector<uint16_t>> &openings)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        std::cout << "Failed to open file " << path << '\n';
+        return false;
+    }
+    uint32_t line_number = 0;
+    for (std::string line; std::getline(in, line);)
+    {
+        line_number++;
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream words(line);
+        std::vector<uint16_t> opening;
+        Board b;
+        for (std::string word; words >> word;)
+        {
+            uint16_t idx;
+            if (!parse_gtp_vertex(word, idx) || !b.make_play(idx) || opening.size() == MAX_OPENING)
+            {
+                std::cout << "Bad opening on line " << line_number << " of " << path << " at " << word << '\n';
+                return false;
+            }
+            opening.push_back(idx);
+        }
+        if (!opening.empty())
+        {
+            openings.push_back(opening);
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 3 && !strcmp(argv[1], "--worker"))
+    {
+        return run_worker(argv[2]);
+    }
+
+    AgentConfig configs[2];
+    std::string specs[2];
+    uint32_t num_games = 100;
+    uint16_t num_workers = 0;
+    uint32_t seed = 1;
+    uint16_t random_plies = 4;
+    uint32_t max_restarts = 100;
+    std::string openings_path;
+    std::string socket_path = "/tmp/stella_farm_" + std::to_string(getpid()) + ".sock";
+    std::string log_path = "match.log";
+    std::string sgf_dir;
+    logLevel verbosity = LOG_RESULTS;
+    bool parsed[2] = {false, false};
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if ((!strcmp(argv[i], "--first") || !strcmp(argv[i], "--second")) && has_value)
+        {
+            int player = !strcmp(argv[i], "--second");
+            specs[player] = argv[++i];
+            parsed[player] = parse_agent_config(specs[player], configs[player]);
+            if (!parsed[player])
+            {
+                printf("Bad agent settings %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--games") && has_value)
+        {
+            num_games = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--workers") && has_value)
+        {
+            num_workers = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--seed") && has_value)
+        {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--random-plies") && has_value)
+        {
+            random_plies = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--openings") && has_value)
+        {
+            openings_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--max-restarts") && has_value)
+        {
+            max_restarts = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--socket") && has_value)
+        {
+            socket_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--log") && has_value)
+        {
+            log_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--sgf-dir") && has_value)
+        {
+            sgf_dir = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--quiet"))
+        {
+            verbosity = LOG_QUIET;
+        }
+        else
+        {
+            printf("usage: %s --first SETTINGS --second SETTINGS [--games N] [--workers N] [--seed N] [--random-plies N] [--openings FILE] [--max-restarts N] [--socket PATH] [--log FILE] [--sgf-dir DIR] [--quiet]\n", argv[0]);
+            printf("settings look like name:depth=3,time=0.2,hash=16,book,patterns,weights=eval_weights.txt\n");
+            return 1;
+        }
+    }
+    if (!parsed[0] || !parsed[1])
+    {
+        printf("Both --first and --second are needed\n");
+        return 1;
+    }
+    num_workers = num_workers ? num_workers : std::max(1U, std::thread::hardware_concurrency());
+
+    // everything the workers will load is checked here once, a worker has nobody to tell
+    if ((configs[0].book || configs[1].book) && !OpeningBook().load(path_to_book))
+    {
+        printf("Failed to load opening book %s\n", path_to_book.c_str());
+        return 1;
+    }
+    if ((configs[0].patterns || configs[1].patterns) && !PatternTable().load(path_to_patterns))
+    {
+        printf("Failed to load pattern table %s\n", path_to_patterns.c_str());
+        return 1;
+    }
+    for (const AgentConfig &config : configs)
+    {
+        Evaluator evaluator;
+        if (!config.weights.empty() && !evaluator.load(config.weights))
+        {
+            printf("Failed to load evaluation weights %s\n", config.weights.c_str());
+            return 1;
+        }
+    }
+    std::vector<std::vector<uint16_t>> openings;
+    if (!openings_path.empty() && !load_openings(openings_path, openings))
+    {
+        return 1;
+    }
+
+    std::ofstream log(log_path);
+    if (!log)
+    {
+        std::cout << "Failed to open file " << log_path << '\n';
+        return 1;
+    }
+    log << "# game\tseed\tblack\twhite\tresult\tmoves\n";
+
+    sockaddr_un address;
+    int listener = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    unlink(socket_path.c_str());
+    if (listener == -1 || !socket_address(socket_path, address) || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(listener, num_workers) != 0)
+    {
+        std::cout << "Failed to listen on " << socket_path << '\n';
+        return 1;
+    }
+
+    // games come in pairs that share an opening and swap colours
+    std::deque<FarmJob> pending;
+    for (uint32_t n = 0; n < num_games; n++)
+    {
+        FarmJob job{n, seed + n / 2, random_plies, 0, {}};
+        if (!openings.empty())
+        {
+            const std::vector<uint16_t> &opening = openings[(n / 2) % openings.size()];
+            job.opening_length = opening.size();
+            std::copy(opening.begin(), opening.end(), job.opening);
+        }
+        pending.push_back(job);
+    }
+    std::string config_text = specs[0] + "\n" + specs[1] + "\n";
+
+    std::vector<FarmWorker> workers;
+    for (uint16_t w = 0; w < num_workers; w++)
+    {
+        workers.push_back(FarmWorker{spawn_worker(socket_path), -1, false, {}});
+    }
+
+    auto give_job = [&](FarmWorker &worker)
+    {
+        if (pending.empty())
+        {
+            return;
+        }
+        worker.job = pending.front();
+        pending.pop_front();
+        worker.busy = send_message(worker.fd, FARM_JOB, &worker.job, sizeof(worker.job));
+        if (!worker.busy)
+        {
+            pending.push_front(worker.job);
+        }
+    };
+    // its game goes back to the front of the queue, the process itself is reaped below
+    auto lose_connection = [&](FarmWorker &worker)
+    {
+        if (worker.busy)
+        {
+            pending.push_front(worker.job);
+            worker.busy = false;
+        }
+        close(worker.fd);
+        worker.fd = -1;
+        kill(worker.pid, SIGKILL);
+    };
+
+    MatchTotals totals;
+    uint32_t restarts = 0;
+    uint32_t crashes = 0;
+    auto start = std::chrono::steady_clock::now();
+    // destroyed, and so written out, before the summary is printed
+    auto game_log = std::make_unique<GameLog>(verbosity);
+    std::vector<uint8_t> message(MAX_MESSAGE);
+    std::vector<pollfd> polled;
+    while (totals.games < num_games)
+    {
+        int status;
+        for (pid_t pid; (pid = waitpid(-1, &status, WNOHANG)) > 0;)
+        {
+            auto worker = std::find_if(workers.begin(), workers.end(), [&](const FarmWorker &w)
+                                       { return w.pid == pid; });
+            if (worker == workers.end())
+            {
+                continue;
+            }
+            if (worker->fd != -1)
+            {
+                lose_connection(*worker);
+            }
+            workers.erase(worker);
+            crashes += !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+            if (restarts < max_restarts)
+            {
+                restarts++;
+                workers.push_back(FarmWorker{spawn_worker(socket_path), -1, false, {}});
+            }
+        }
+        if (workers.empty())
+        {
+            std::cout << "Every worker has died and the restart limit is used up" << '\n';
+            break;
+        }
+
+        polled.assign(1, pollfd{listener, POLLIN, 0});
+        for (const FarmWorker &worker : workers)
+        {
+            if (worker.fd != -1)
+            {
+                polled.push_back(pollfd{worker.fd, POLLIN, 0});
+            }
+        }
+        // the timeout is how often dead workers get reaped
+        if (poll(polled.data(), polled.size(), 100) <= 0)
+        {
+            continue;
+        }
+
+        if (polled[0].revents & POLLIN)
+        {
+            int fd = accept(listener, nullptr, nullptr);
+            uint32_t pid = 0;
+            ssize_t size = fd == -1 ? -1 : recv(fd, message.data(), message.size(), 0);
+            if (size == 1 + sizeof(pid) && message[0] == FARM_HELLO)
+            {
+                memcpy(&pid, message.data() + 1, sizeof(pid));
+            }
+            auto worker = std::find_if(workers.begin(), workers.end(), [&](const FarmWorker &w)
+                                       { return w.pid == pid_t(pid) && w.fd == -1; });
+            if (worker == workers.end())
+            {
+                if (fd != -1)
+                {
+                    close(fd);
+                }
+            }
+            else
+            {
+                worker->fd = fd;
+                if (send_message(fd, FARM_CONFIGS, config_text.data(), config_text.size()))
+                {
+                    give_job(*worker);
+                }
+                else
+                {
+                    lose_connection(*worker);
+                }
+            }
+        }
+
+        for (size_t p = 1; p < polled.size(); p++)
+        {
+            if (polled[p].revents == 0)
+            {
+                continue;
+            }
+            auto worker = std::find_if(workers.begin(), workers.end(), [&](const FarmWorker &w)
+                                       { return w.fd == polled[p].fd; });
+            if (worker == workers.end())
+            {
+                continue;
+            }
+            ssize_t size = recv(worker->fd, message.data(), message.size(), 0);
+            FarmResult result;
+            if (size < ssize_t(1 + sizeof(result)) || message[0] != FARM_RESULT || !worker->busy)
+            {
+                lose_connection(*worker);
+                continue;
+            }
+            memcpy(&result, message.data() + 1, sizeof(result));
+            if (size != ssize_t(1 + sizeof(result) + result.num_moves * sizeof(uint16_t)) || result.number != worker->job.number)
+            {
+                lose_connection(*worker);
+                continue;
+            }
+            worker->busy = false;
+            give_job(*worker);
+
+            MatchGame game{result.number, result.seed, bool(result.first_is_black), std::vector<uint16_t>(result.num_moves), result.margin,
+                           {result.think_seconds[0], result.think_seconds[1]}, {result.searched_moves[0], result.searched_moves[1]}};
+            memcpy(game.moves.data(), message.data() + 1 + sizeof(result), result.num_moves * sizeof(uint16_t));
+            const std::string &black = configs[game.first_is_black ? 0 : 1].name;
+            const std::string &white = configs[game.first_is_black ? 1 : 0].name;
+            if (!sgf_dir.empty())
+            {
+                GameRecord record;
+                record.moves = game.moves;
+                record.komi = komi;
+                game_log->write_file(sgf_dir + "/game_" + std::to_string(game.number) + ".sgf", format_sgf(record, SGFGameInfo{black, white, sgf_result(game.margin)}));
+            }
+            log << match_log_line(game, black, white);
+            totals.add(game);
+            if (game_log->enabled(LOG_RESULTS))
+            {
+                char line[256];
+                snprintf(line, sizeof(line), "game %u: %s (black) vs %s (white) %s in %zu moves, %s %.1f/%u\n", game.number, black.c_str(), white.c_str(),
+                         sgf_result(game.margin).c_str(), game.moves.size(), configs[0].name.c_str(), totals.wins, totals.games);
+                game_log->write(LOG_RESULTS, line);
+            }
+        }
+    }
+
+    for (FarmWorker &worker : workers)
+    {
+        if (worker.fd != -1)
+        {
+            send_message(worker.fd, FARM_STOP, nullptr, 0);
+            close(worker.fd);
+        }
+        else
+        {
+            // never connected, there is nobody to tell
+            kill(worker.pid, SIGKILL);
+        }
+    }
+    for (const FarmWorker &worker : workers)
+    {
+        waitpid(worker.pid, nullptr, 0);
+    }
+    close(listener);
+    unlink(socket_path.c_str());
+
+    uint64_t dropped = game_log->get_dropped();
+    game_log.reset();
+    if (dropped)
+    {
+        printf("%lu log lines dropped\n", (unsigned long)dropped);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (totals.games == 0)
+    {
+        return 1;
+    }
+    printf("%u games in %.1fs on %u workers: %.1f games/hour, %.0f moves/game, %u workers crashed, %u restarted\n", totals.games, seconds,
+           num_workers, totals.games * 3600 / seconds, double(totals.plies) / totals.games, crashes, restarts);
+    print_match_summary(totals, configs);
+    return totals.games == num_games ? 0 : 1;
+}
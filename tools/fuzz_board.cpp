@@ -0,0 +1,413 @@
+/* Differential fuzzer for the chain management code. Random games are played on Board and on
+   ReferenceBoard side by side, and after every move the two have to agree on whether the move was
+   legal, on every point, the stone counts, all 8 hashes and the liberties of every chain, and every
+   few moves on the legality of every empty point. Games are seeded from --seed and their number, so a
+   run is repeatable. On the first difference the game is cut down to a short sequence of moves that
+   still shows it, printed in a form --replay accepts. At the end of each game the legal moves are also
+   loaded in one go with play_sequence, which has to arrive at the same board. With --fast-only the same games are played on
+   Board alone, as a throughput check. */
+#include "GTPEngine.h"
+#include "ReferenceBoard.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+static const std::array<const char *, 4> error_names = {"ok", "occupied", "suicide", "ko"};
+
+struct FuzzSettings
+{
+    uint64_t seed = 1;
+    uint32_t max_moves = 3 * BOARD_SIZE * BOARD_SIZE;
+    uint32_t legality_every = 8; // the full legality sweep costs as much as the rest put together
+    double pass_rate = 0.02;
+};
+
+// the first thing the two boards disagree on, empty if nothing
+static std::string compare(const Board &b, const ReferenceBoard &reference, bool check_legality)
+{
+    std::ostringstream difference;
+    if (b.whose_turn() != reference.whose_turn())
+    {
+        difference << "side to move differs";
+        return difference.str();
+    }
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        if (b.get_point(i) != reference.get_point(i))
+        {
+            difference << "point " << gtp_vertex(i) << " is " << b.get_point(i) << ", reference " << reference.get_point(i);
+            return difference.str();
+        }
+    }
+    for (bool black : {true, false})
+    {
+        if (b.get_stone_count(black) != reference.get_stone_count(black))
+        {
+            difference << (black ? "black" : "white") << " stone count " << b.get_stone_count(black) << ", reference " << reference.get_stone_count(black);
+            return difference.str();
+        }
+    }
+    for (uint8_t t = 0; t < NUM_SYMMETRIES; t++)
+    {
+        if (b.get_symmetric_hash(t) != reference.get_symmetric_hash(t))
+        {
+            difference << "hash for symmetry " << int(t) << " differs";
+            return difference.str();
+        }
+    }
+    std::array<uint16_t, NUM_POINTS> liberties;
+    reference.get_all_liberties(liberties);
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        pointType point = b.get_point(i);
+        if ((point == pointType::BLACK || point == pointType::WHITE) && b.get_chain_liberties(i) != liberties[i])
+        {
+            difference << "chain at " << gtp_vertex(i) << " has " << b.get_chain_liberties(i) << " liberties, reference " << liberties[i];
+            return difference.str();
+        }
+    }
+    for (uint16_t i = 0; check_legality && i < NUM_POINTS; i++)
+    {
+        if (b.get_point(i) == pointType::EMPTY && b.get_play_error(i) != reference.get_play_error(i))
+        {
+            difference << "playing " << gtp_vertex(i) << " is " << error_names[b.get_play_error(i)] << ", reference " << error_names[reference.get_play_error(i)];
+            return difference.str();
+        }
+    }
+    return "";
+}
+
+// the same checks between the board a game was played on and the one play_sequence built from its moves
+static std::string compare_loaded(const Board &b, const std::vector<uint16_t> &legal_moves)
+{
+    Board loaded;
+    if (loaded.play_sequence(legal_moves.data(), legal_moves.size()) != legal_moves.size())
+    {
+        return "play_sequence stopped early";
+    }
+    std::ostringstream difference;
+    if (b.whose_turn() != loaded.whose_turn() || b.get_stone_count(true) != loaded.get_stone_count(true) ||
+        b.get_stone_count(false) != loaded.get_stone_count(false))
+    {
+        difference << "play_sequence gives a different side to move or stone count";
+        return difference.str();
+    }
+    for (uint8_t t = 0; t < NUM_SYMMETRIES; t++)
+    {
+        if (b.get_symmetric_hash(t) != loaded.get_symmetric_hash(t))
+        {
+            difference << "play_sequence gives a different hash for symmetry " << int(t);
+            return difference.str();
+        }
+    }
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        pointType point = b.get_point(i);
+        if (point != loaded.get_point(i))
+        {
+            difference << "play_sequence leaves " << gtp_vertex(i) << " as " << loaded.get_point(i) << ", not " << point;
+            return difference.str();
+        }
+        if ((point == pointType::BLACK || point == pointType::WHITE) && b.get_chain_liberties(i) != loaded.get_chain_liberties(i))
+        {
+            difference << "play_sequence gives the chain at " << gtp_vertex(i) << " " << loaded.get_chain_liberties(i) << " liberties, not " << b.get_chain_liberties(i);
+            return difference.str();
+        }
+        // ko included, so the ko hashes have to match too
+        if (point == pointType::EMPTY && b.get_play_error(i) != loaded.get_play_error(i))
+        {
+            difference << "after play_sequence playing " << gtp_vertex(i) << " is " << error_names[loaded.get_play_error(i)] << ", not " << error_names[b.get_play_error(i)];
+            return difference.str();
+        }
+    }
+    if (!loaded.is_consistent())
+    {
+        return "play_sequence leaves inconsistent chains";
+    }
+    return "";
+}
+
+// plays the moves on both boards, checking everything after each one, and the loaded board at the end; returns the first difference
+// and sets length to the number of moves it took to show up
+static std::string replay(const std::vector<uint16_t> &moves, size_t &length)
+{
+    Board b;
+    ReferenceBoard reference;
+    std::vector<uint16_t> legal_moves;
+    for (length = 1; length <= moves.size(); length++)
+    {
+        uint16_t move = moves[length - 1];
+        bool played = b.make_play(move);
+        if (played != reference.make_play(move))
+        {
+            return "playing " + gtp_vertex(move) + (played ? " is legal, reference says it isn't" : " is illegal, reference says it is");
+        }
+        if (played)
+        {
+            legal_moves.push_back(move);
+        }
+        std::string difference = compare(b, reference, true);
+        if (!difference.empty())
+        {
+            return difference;
+        }
+    }
+    length = moves.size();
+    return compare_loaded(b, legal_moves);
+}
+
+// drops runs of moves, halving the run length down to single moves, as long as the boards still
+// disagree without them; a dropped move can turn later ones illegal, which both boards then have to
+// agree on as well
+static std::vector<uint16_t> minimise(std::vector<uint16_t> moves)
+{
+    size_t length;
+    if (replay(moves, length).empty())
+    {
+        return moves;
+    }
+    moves.resize(length);
+    for (size_t run = std::max<size_t>(moves.size() / 2, 1); run > 0; run /= 2)
+    {
+        for (size_t start = 0; start < moves.size();)
+        {
+            std::vector<uint16_t> shorter = moves;
+            shorter.erase(shorter.begin() + start, shorter.begin() + std::min(start + run, shorter.size()));
+            if (!shorter.empty() && !replay(shorter, length).empty())
+            {
+                shorter.resize(length);
+                moves = shorter;
+            }
+            else
+            {
+                start += run;
+            }
+        }
+    }
+    return moves;
+}
+
+static std::string format_moves(const std::vector<uint16_t> &moves)
+{
+    std::string text;
+    for (uint16_t move : moves)
+    {
+        text += (text.empty() ? "" : " ") + gtp_vertex(move);
+    }
+    return text;
+}
+
+// a pass now and then, otherwise any empty point; illegal ones included, the boards have to agree on those too
+static uint16_t random_move(const Board &b, std::mt19937_64 &rng, double pass_rate)
+{
+    if (std::uniform_real_distribution<double>(0, 1)(rng) < pass_rate)
+    {
+        return PASS;
+    }
+    std::array<uint16_t, BOARD_SIZE * BOARD_SIZE> empty;
+    uint16_t num_empty = 0;
+    for (uint16_t y = 0; y < BOARD_SIZE; y++)
+    {
+        for (uint16_t x = 0; x < BOARD_SIZE; x++)
+        {
+            uint16_t idx = Board::coords_to_idx(x, y);
+            if (b.get_point(idx) == pointType::EMPTY)
+            {
+                empty[num_empty++] = idx;
+            }
+        }
+    }
+    return num_empty ? empty[rng() % num_empty] : PASS;
+}
+
+struct GameResult
+{
+    uint64_t moves = 0; // attempted, legal or not
+    uint64_t legal = 0;
+    std::vector<uint16_t> played; // every attempt, for the reproducer
+    std::vector<uint16_t> legal_moves;
+    std::string difference;
+};
+
+static GameResult fuzz_game(const FuzzSettings &settings, uint64_t game, bool fast_only)
+{
+    GameResult result;
+    std::mt19937_64 rng(settings.seed * 0x9e3779b97f4a7c15 + game);
+    Board b;
+    ReferenceBoard reference;
+    bool passed = false;
+    for (uint32_t m = 0; m < settings.max_moves; m++)
+    {
+        uint16_t move = random_move(b, rng, settings.pass_rate);
+        result.moves++;
+        bool played = b.make_play(move);
+        result.legal += played;
+        if (!fast_only)
+        {
+            result.played.push_back(move);
+            if (played)
+            {
+                result.legal_moves.push_back(move);
+            }
+            if (played != reference.make_play(move))
+            {
+                result.difference = "legality of " + gtp_vertex(move) + " differs";
+                return result;
+            }
+            result.difference = compare(b, reference, m % settings.legality_every == 0);
+            if (!result.difference.empty())
+            {
+                return result;
+            }
+        }
+        // two passes in a row end the game
+        if (move == PASS && passed)
+        {
+            break;
+        }
+        passed = move == PASS;
+    }
+    if (!fast_only)
+    {
+        result.difference = compare_loaded(b, result.legal_moves);
+    }
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    FuzzSettings settings;
+    uint64_t num_games = 10000;
+    uint16_t num_threads = 0;
+    bool fast_only = false;
+    std::string replay_moves;
+    bool replaying = false;
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--games") && has_value)
+        {
+            num_games = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--threads") && has_value)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--seed") && has_value)
+        {
+            settings.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--max-moves") && has_value)
+        {
+            settings.max_moves = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--legality-every") && has_value)
+        {
+            settings.legality_every = std::max(1UL, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--pass-rate") && has_value)
+        {
+            settings.pass_rate = std::strtod(argv[++i], nullptr);
+        }
+        else if (!strcmp(argv[i], "--fast-only"))
+        {
+            fast_only = true;
+        }
+        else if (!strcmp(argv[i], "--replay") && has_value)
+        {
+            replay_moves = argv[++i];
+            replaying = true;
+        }
+        else
+        {
+            printf("usage: %s [--games N] [--threads N] [--seed N] [--max-moves N] [--legality-every N] [--pass-rate P] [--fast-only] [--replay \"D4 C3 ...\"]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (replaying)
+    {
+        std::vector<uint16_t> moves;
+        std::istringstream words(replay_moves);
+        for (std::string word; words >> word;)
+        {
+            uint16_t idx;
+            if (!parse_gtp_vertex(word, idx))
+            {
+                printf("Bad move %s\n", word.c_str());
+                return 1;
+            }
+            moves.push_back(idx);
+        }
+        size_t length;
+        std::string difference = replay(moves, length);
+        if (difference.empty())
+        {
+            printf("boards agree after all %zu moves\n", moves.size());
+            return 0;
+        }
+        printf("boards differ after move %zu (%s): %s\n", length, gtp_vertex(moves[length - 1]).c_str(), difference.c_str());
+        return 2;
+    }
+
+    num_threads = num_threads ? num_threads : std::max(1U, std::thread::hardware_concurrency());
+    std::atomic<uint64_t> next_game{0};
+    std::atomic<uint64_t> total_moves{0};
+    std::atomic<uint64_t> total_legal{0};
+    std::atomic<bool> failed{false};
+    std::mutex mutex;
+    uint64_t failed_game = 0;
+    GameResult failure;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (uint16_t t = 0; t < num_threads; t++)
+    {
+        workers.emplace_back([&]()
+                             {
+            for (uint64_t game = next_game++; game < num_games && !failed; game = next_game++)
+            {
+                GameResult result = fuzz_game(settings, game, fast_only);
+                total_moves += result.moves;
+                total_legal += result.legal;
+                if (!result.difference.empty())
+                {
+                    // the lowest numbered failing game is reported, so reruns report the same one
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!failed || game < failed_game)
+                    {
+                        failed_game = game;
+                        failure = std::move(result);
+                    }
+                    failed = true;
+                }
+            } });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t games_played = std::min<uint64_t>(next_game, num_games);
+    printf("%lu games, %lu moves (%lu legal) in %.2fs on %u threads: %.0f moves/s%s\n", (unsigned long)games_played,
+           (unsigned long)total_moves.load(), (unsigned long)total_legal.load(), seconds, num_threads, total_moves / seconds,
+           fast_only ? ", fast board only" : "");
+    if (!failed)
+    {
+        return 0;
+    }
+
+    printf("game %lu (seed %lu) diverged after %zu moves: %s\n", (unsigned long)failed_game, (unsigned long)settings.seed,
+           failure.played.size(), failure.difference.c_str());
+    std::vector<uint16_t> reproducer = minimise(failure.played);
+    size_t length;
+    std::string difference = replay(reproducer, length);
+    printf("minimal reproducer, %zu moves: %s\n", reproducer.size(), difference.c_str());
+    printf("%s --replay \"%s\"\n", argv[0], format_moves(reproducer).c_str());
+    return 2;
+}
@@ -0,0 +1,364 @@
+/* Derives the static move ordering tables from a game corpus and writes them as a constexpr header,
+   see MoveOrdering.h. For every requested board size and game phase it counts how often each point
+   gets played, folds the counts over the 8 board symmetries, and turns them into a point weight
+   (log of the play rate relative to a uniform choice) and a checking order (most played first). */
+#include "Config.h"
+#include "CorpusScan.h"
+#include "GameArchive.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+static constexpr uint8_t MAX_TABLE_SIZE = 25;
+static constexpr uint8_t MAX_PHASES = 8;
+
+struct PhaseConfig
+{
+    uint16_t num_phases = 0;
+    std::array<uint16_t, MAX_PHASES> starts{}; // first ply of each phase, starts[0] is always 0
+};
+
+// filled in from the command line before scanning, read only afterwards
+static std::array<PhaseConfig, MAX_TABLE_SIZE + 1> phase_configs;
+
+static uint16_t phase_of(uint8_t size, uint32_t ply)
+{
+    const PhaseConfig &config = phase_configs[size];
+    uint16_t phase = 0;
+    while (phase + 1 < config.num_phases && ply >= config.starts[phase + 1])
+    {
+        phase++;
+    }
+    return phase;
+}
+
+// per thread statistics for scan_corpus and scan_archive
+struct PlayCounts
+{
+    // counts[size] holds num_phases blocks of size * size counts, indexed row * size + column
+    std::array<std::vector<uint64_t>, MAX_TABLE_SIZE + 1> counts;
+    std::array<uint64_t, MAX_TABLE_SIZE + 1> games{};
+
+    void add_play(uint8_t size, uint32_t ply, uint8_t x, uint8_t y)
+    {
+        std::vector<uint64_t> &size_counts = counts[size];
+        if (size_counts.empty())
+        {
+            size_counts.resize(phase_configs[size].num_phases * size * size);
+        }
+        size_counts[phase_of(size, ply) * size * size + y * size + x]++;
+    }
+
+    void add(const PlayCounts &other)
+    {
+        for (uint8_t size = 0; size <= MAX_TABLE_SIZE; size++)
+        {
+            games[size] += other.games[size];
+            if (other.counts[size].empty())
+            {
+                continue;
+            }
+            if (counts[size].empty())
+            {
+                counts[size].resize(other.counts[size].size());
+            }
+            for (uint32_t i = 0; i < counts[size].size(); i++)
+            {
+                counts[size][i] += other.counts[size][i];
+            }
+        }
+    }
+};
+
+static bool wanted(uint8_t size)
+{
+    return size <= MAX_TABLE_SIZE && phase_configs[size].num_phases;
+}
+
+static void count_game(const SGFFile &file, PlayCounts &stats)
+{
+    uint8_t size = file.get_size();
+    if (!wanted(size))
+    {
+        return;
+    }
+    stats.games[size]++;
+    const std::vector<SGFMove> &moves = file.get_moves();
+    for (uint32_t ply = 0; ply < moves.size(); ply++)
+    {
+        if (moves[ply].x != SGF_PASS && moves[ply].x < size && moves[ply].y < size)
+        {
+            stats.add_play(size, ply, moves[ply].x, moves[ply].y);
+        }
+    }
+}
+
+static void count_game(const GameView &game, PlayCounts &stats)
+{
+    uint8_t size = game.header->size;
+    if (!wanted(size))
+    {
+        return;
+    }
+    stats.games[size]++;
+    for (uint32_t ply = 0; ply < game.num_moves(); ply++)
+    {
+        uint16_t point = game.move(ply);
+        if (point != ARCHIVE_PASS && point < size * size)
+        {
+            stats.add_play(size, ply, point % size, point / size);
+        }
+    }
+}
+
+// sums the counts of the 8 points a point maps to under rotation and reflection
+static std::vector<uint64_t> fold_symmetries(const uint64_t *counts, uint8_t size)
+{
+    std::vector<uint64_t> folded(size * size);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            int m = size - 1;
+            std::array<std::pair<int, int>, 8> images = {{{x, y}, {m - x, y}, {x, m - y}, {m - x, m - y}, {y, x}, {m - y, x}, {y, m - x}, {m - y, m - x}}};
+            for (const std::pair<int, int> &image : images)
+            {
+                folded[y * size + x] += counts[image.second * size + image.first];
+            }
+        }
+    }
+    return folded;
+}
+
+static std::string join(const std::vector<int> &values)
+{
+    std::ostringstream out;
+    for (uint32_t i = 0; i < values.size(); i++)
+    {
+        out << (i ? ", " : "") << values[i];
+    }
+    return out.str();
+}
+
+static void write_tables(std::ostream &out, uint8_t size, const PlayCounts &stats, bool symmetric)
+{
+    const PhaseConfig &config = phase_configs[size];
+    uint16_t width = size + 2;
+    std::vector<std::vector<int>> weights(config.num_phases, std::vector<int>(width * width, 0));
+    std::vector<std::vector<int>> orders(config.num_phases);
+
+    for (uint16_t phase = 0; phase < config.num_phases; phase++)
+    {
+        const uint64_t *phase_counts = stats.counts[size].data() + phase * size * size;
+        std::vector<uint64_t> counts = symmetric ? fold_symmetries(phase_counts, size) : std::vector<uint64_t>(phase_counts, phase_counts + size * size);
+        uint64_t total = 0;
+        for (uint64_t count : counts)
+        {
+            total += count;
+        }
+        double uniform = double(total) / (size * size);
+
+        std::vector<int> points;
+        for (int y = 0; y < size; y++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                // ten steps per doubling of the play rate, the +1 keeps never played points finite
+                double weight = 10 * std::log2((counts[y * size + x] + 1) / (uniform + 1));
+                weights[phase][(y + 1) * width + x + 1] = std::clamp(int(std::lround(weight)), -127, 127);
+                points.push_back(y * size + x);
+            }
+        }
+        std::stable_sort(points.begin(), points.end(), [&counts](int a, int b)
+                         { return counts[a] > counts[b]; });
+        for (int point : points)
+        {
+            orders[phase].push_back((point / size + 1) * width + point % size + 1);
+        }
+    }
+
+    std::vector<int> starts(config.starts.begin(), config.starts.begin() + config.num_phases);
+    out << "// " << int(size) << "x" << int(size) << ": " << stats.games[size] << " games" << (symmetric ? ", folded over the board symmetries" : "") << '\n';
+    out << "template <>\nstruct OrderingTables<" << int(size) << ">\n{\n";
+    out << "    static constexpr uint16_t num_phases = " << config.num_phases << ";\n";
+    out << "    static constexpr std::array<uint16_t, " << config.num_phases << "> phase_starts = {" << join(starts) << "};\n";
+    out << "    static constexpr std::array<std::array<int8_t, " << width * width << ">, " << config.num_phases << "> point_weights = {{";
+    for (uint16_t phase = 0; phase < config.num_phases; phase++)
+    {
+        out << (phase ? ",\n" : "\n") << "        {" << join(weights[phase]) << "}";
+    }
+    out << "}};\n";
+    out << "    static constexpr std::array<std::array<uint16_t, " << size * size << ">, " << config.num_phases << "> move_order = {{";
+    for (uint16_t phase = 0; phase < config.num_phases; phase++)
+    {
+        out << (phase ? ",\n" : "\n") << "        {" << join(orders[phase]) << "}";
+    }
+    out << "}};\n};\n\n";
+}
+
+// the specialisations already in the header at path, by size, each with the comment line above it
+static std::map<int, std::string> read_existing_tables(const std::string &path)
+{
+    std::map<int, std::string> tables;
+    std::ifstream in(path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+    const std::string marker = "template <>\nstruct OrderingTables<";
+    for (size_t at = text.find(marker); at != std::string::npos; at = text.find(marker, at + marker.size()))
+    {
+        size_t end = text.find("\n};\n", at);
+        if (end == std::string::npos)
+        {
+            break;
+        }
+        size_t start = at;
+        size_t comment = at > 1 ? text.rfind('\n', at - 2) : std::string::npos;
+        comment = comment == std::string::npos ? 0 : comment + 1;
+        if (text.compare(comment, 2, "//") == 0)
+        {
+            start = comment;
+        }
+        int size = std::atoi(text.c_str() + at + marker.size());
+        tables[size] = text.substr(start, end + 4 - start) + "\n";
+    }
+    return tables;
+}
+
+int main(int argc, char **argv)
+{
+    std::string games = path_to_games;
+    std::string output = "src/OrderingTables.h";
+    uint16_t num_threads = 0;
+    std::vector<uint8_t> sizes;
+    std::vector<uint16_t> phase_starts;
+    bool default_phases = true;
+    bool symmetric = true;
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--threads") && has_value)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--size") && has_value)
+        {
+            sizes.push_back(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--phase-starts") && has_value)
+        {
+            // comma separated plies where the middle game, endgame, ... begin, empty for a single table
+            default_phases = false;
+            char *start = argv[++i];
+            while (*start)
+            {
+                char *end;
+                uint16_t ply = std::strtoul(start, &end, 10);
+                if (end == start)
+                {
+                    break;
+                }
+                phase_starts.push_back(ply);
+                start = *end == ',' ? end + 1 : end;
+            }
+        }
+        else if (!strcmp(argv[i], "--no-symmetry"))
+        {
+            symmetric = false;
+        }
+        else if (!strcmp(argv[i], "-o") && has_value)
+        {
+            output = argv[++i];
+        }
+        else if (argv[i][0] != '-')
+        {
+            games = argv[i];
+        }
+        else
+        {
+            printf("usage: %s [games directory or archive.sga] [--size N]... [--phase-starts P1,P2,...] [--no-symmetry] [--threads N] [-o header]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (sizes.empty())
+    {
+        sizes.push_back(BOARD_SIZE);
+    }
+
+    for (uint8_t size : sizes)
+    {
+        if (size < 2 || size > MAX_TABLE_SIZE)
+        {
+            printf("Board size %d is not supported, tables go up to %d\n", size, MAX_TABLE_SIZE);
+            return 1;
+        }
+        PhaseConfig &config = phase_configs[size];
+        // by default the opening is the first sixth of the points and the endgame starts once half are played
+        std::vector<uint16_t> starts = default_phases ? std::vector<uint16_t>{uint16_t(size * size / 6), uint16_t(size * size / 2)} : phase_starts;
+        config.num_phases = 1;
+        for (uint16_t start : starts)
+        {
+            if (config.num_phases < MAX_PHASES && start > config.starts[config.num_phases - 1])
+            {
+                config.starts[config.num_phases++] = start;
+            }
+        }
+    }
+
+    PlayCounts stats;
+    if (std::filesystem::path(games).extension() == ".sga")
+    {
+        GameArchive archive(games);
+        if (!archive.is_valid())
+        {
+            std::cout << "Failed to open archive " << games << '\n';
+            return 1;
+        }
+        stats = scan_archive<PlayCounts>(archive, num_threads, [](const GameView &game, PlayCounts &thread_stats)
+                                         { count_game(game, thread_stats); });
+    }
+    else
+    {
+        stats = scan_corpus<PlayCounts>(games, num_threads, [](const SGFFile &file, PlayCounts &thread_stats)
+                                        { count_game(file, thread_stats); });
+    }
+
+    // sizes without games, requested or not, keep whatever the header had for them
+    std::map<int, std::string> tables = read_existing_tables(output);
+    for (uint8_t size : sizes)
+    {
+        if (stats.counts[size].empty())
+        {
+            printf("No %dx%d games in %s, %s\n", size, size, games.c_str(), tables.count(size) ? "that size keeps its existing tables" : "that size has no tables");
+            continue;
+        }
+        std::ostringstream table;
+        write_tables(table, size, stats, symmetric);
+        tables[size] = table.str();
+        printf("%dx%d: %lu games, %d phases\n", size, size, (unsigned long)stats.games[size], phase_configs[size].num_phases);
+    }
+
+    std::ofstream out(output);
+    if (!out)
+    {
+        std::cout << "Failed to open file " << output << '\n';
+        return 1;
+    }
+    out << "#ifndef ORDERING_TABLES_H\n#define ORDERING_TABLES_H\n";
+    out << "/* Generated by tools/gen_tables from " << games << ", rerun make tables instead of editing.\n";
+    out << "   Specialisations of OrderingTables for the board sizes found in the corpus, and those the previous\n";
+    out << "   header had for other sizes, see MoveOrdering.h. */\n";
+    out << "#include <array>\n#include <cstdint>\n\n";
+    out << "template <int size>\nstruct OrderingTables;\n\n";
+    for (const auto &[size, table] : tables)
+    {
+        out << table;
+    }
+    out << "#endif\n";
+    return out.good() ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+/* Plays a match between two agent configurations on a pool of threads. Games come in pairs that share
+   a random opening and swap colours, every finished game is appended to a log as one line, and the
+   summary gives throughput, time per move and the first player's score with a 95% interval. Console
+   lines and SGF files go through a GameLog, so the players never wait on output. */
+#include "GTPEngine.h"
+#include "GameLog.h"
+#include "Match.h"
+#include "SGFWriter.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+int main(int argc, char **argv)
+{
+    AgentConfig configs[2];
+    uint32_t num_games = 100;
+    uint16_t num_threads = 0;
+    uint32_t seed = 1;
+    uint16_t random_plies = 4;
+    std::string log_path = "match.log";
+    std::string sgf_dir;
+    logLevel verbosity = LOG_RESULTS;
+    bool parsed[2] = {false, false};
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if ((!strcmp(argv[i], "--first") || !strcmp(argv[i], "--second")) && has_value)
+        {
+            int player = !strcmp(argv[i], "--second");
+            parsed[player] = parse_agent_config(argv[++i], configs[player]);
+            if (!parsed[player])
+            {
+                printf("Bad agent settings %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--games") && has_value)
+        {
+            num_games = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--threads") && has_value)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--seed") && has_value)
+        {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--random-plies") && has_value)
+        {
+            random_plies = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--log") && has_value)
+        {
+            log_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--sgf-dir") && has_value)
+        {
+            sgf_dir = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--quiet"))
+        {
+            verbosity = LOG_QUIET;
+        }
+        else
+        {
+            printf("usage: %s --first SETTINGS --second SETTINGS [--games N] [--threads N] [--seed N] [--random-plies N] [--log FILE] [--sgf-dir DIR] [--quiet]\n", argv[0]);
+            printf("settings look like name:depth=3,time=0.2,hash=16,book,patterns,weights=eval_weights.txt\n");
+            return 1;
+        }
+    }
+    if (!parsed[0] || !parsed[1])
+    {
+        printf("Both --first and --second are needed\n");
+        return 1;
+    }
+    num_threads = num_threads ? num_threads : std::max(1U, std::thread::hardware_concurrency());
+
+    std::shared_ptr<OpeningBook> book = std::make_shared<OpeningBook>();
+    if ((configs[0].book || configs[1].book) && !book->load(path_to_book))
+    {
+        printf("Failed to load opening book %s\n", path_to_book.c_str());
+        return 1;
+    }
+    std::shared_ptr<PatternTable> patterns = std::make_shared<PatternTable>();
+    if ((configs[0].patterns || configs[1].patterns) && !patterns->load(path_to_patterns))
+    {
+        printf("Failed to load pattern table %s\n", path_to_patterns.c_str());
+        return 1;
+    }
+    for (const AgentConfig &config : configs)
+    {
+        // every player loads its own copy, this only checks the file before any games start
+        Evaluator evaluator;
+        if (!config.weights.empty() && !evaluator.load(config.weights))
+        {
+            printf("Failed to load evaluation weights %s\n", config.weights.c_str());
+            return 1;
+        }
+    }
+
+    std::ofstream log(log_path);
+    if (!log)
+    {
+        std::cout << "Failed to open file " << log_path << '\n';
+        return 1;
+    }
+    log << "# game\tseed\tblack\twhite\tresult\tmoves\n";
+
+    std::mutex mutex;
+    MatchTotals totals;
+    std::atomic<uint32_t> next_game{0};
+    auto start = std::chrono::steady_clock::now();
+    // destroyed, and so written out, before the summary is printed
+    auto game_log = std::make_unique<GameLog>(verbosity);
+    std::vector<std::thread> workers;
+    for (uint16_t t = 0; t < num_threads; t++)
+    {
+        workers.emplace_back([&]()
+                             {
+            MatchPlayer first(configs[0], book, patterns);
+            MatchPlayer second(configs[1], book, patterns);
+            for (uint32_t n = next_game++; n < num_games; n = next_game++)
+            {
+                // both games of a pair open the same way
+                MatchGame game = play_match_game(first, second, n, seed + n / 2, random_plies);
+
+                const std::string &black = configs[game.first_is_black ? 0 : 1].name;
+                const std::string &white = configs[game.first_is_black ? 1 : 0].name;
+                if (!sgf_dir.empty())
+                {
+                    GameRecord record;
+                    record.moves = game.moves;
+                    record.komi = komi;
+                    game_log->write_file(sgf_dir + "/game_" + std::to_string(n) + ".sgf", format_sgf(record, SGFGameInfo{black, white, sgf_result(game.margin)}));
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                log << match_log_line(game, black, white);
+                totals.add(game);
+                if (game_log->enabled(LOG_RESULTS))
+                {
+                    char line[256];
+                    snprintf(line, sizeof(line), "game %u: %s (black) vs %s (white) %s in %zu moves, %s %.1f/%u\n", n, black.c_str(), white.c_str(),
+                             sgf_result(game.margin).c_str(), game.moves.size(), configs[0].name.c_str(), totals.wins, totals.games);
+                    game_log->write(LOG_RESULTS, line);
+                }
+            } });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    uint64_t dropped = game_log->get_dropped();
+    game_log.reset();
+    if (dropped)
+    {
+        printf("%lu log lines dropped\n", (unsigned long)dropped);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (totals.games == 0)
+    {
+        return 0;
+    }
+
+    printf("%u games in %.1fs on %u threads: %.1f games/hour, %.0f moves/game\n", totals.games, seconds, num_threads,
+           totals.games * 3600 / seconds, double(totals.plies) / totals.games);
+    print_match_summary(totals, configs);
+    return 0;
+}
@@ -0,0 +1,85 @@
+/* Mines local shape patterns (see Patterns.h) from a directory of SGF files or a .sga archive. Every
+   position of every game is replayed and the pattern of each legal move is counted, together with
+   how often it was the move actually played. Only games on BOARD_SIZE boards without setup stones
+   are used. */
+#include "GameRecord.h"
+#include "Patterns.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char **argv)
+{
+    std::string games = path_to_games;
+    std::string output = path_to_patterns;
+    uint16_t num_threads = 0;
+    uint64_t min_seen = 50;
+    bool diamond = false;
+    uint32_t top = 10;
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--threads") && has_value)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--min-seen") && has_value)
+        {
+            min_seen = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--top") && has_value)
+        {
+            top = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--diamond"))
+        {
+            diamond = true;
+        }
+        else if (!strcmp(argv[i], "-o") && has_value)
+        {
+            output = argv[++i];
+        }
+        else if (argv[i][0] != '-')
+        {
+            games = argv[i];
+        }
+        else
+        {
+            printf("usage: %s [games directory or archive.sga] [-o table] [--diamond] [--min-seen N] [--top N] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    PatternMiner miner = scan_records<PatternMiner>(games, num_threads, [diamond](const GameRecord &record, PatternMiner &thread_miner)
+                                                    { thread_miner.add_game(record, diamond); });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int64_t entries = miner.write(output, min_seen, diamond);
+    if (entries < 0)
+    {
+        return 1;
+    }
+    printf("%lu positions in %.2fs (%.0f positions/s), %lu distinct patterns, wrote %ld seen at least %lu times to %s\n",
+           (unsigned long)miner.positions, seconds, miner.positions / seconds, (unsigned long)miner.counts.size(),
+           (long)entries, (unsigned long)min_seen, output.c_str());
+
+    std::vector<std::pair<uint32_t, PatternCounts>> best;
+    for (const auto &[key, counts] : miner.counts)
+    {
+        if (counts.seen >= min_seen)
+        {
+            best.emplace_back(key, counts);
+        }
+    }
+    std::sort(best.begin(), best.end(), [](const std::pair<uint32_t, PatternCounts> &a, const std::pair<uint32_t, PatternCounts> &b)
+              { return a.second.played * b.second.seen > b.second.played * a.second.seen; });
+    for (uint32_t i = 0; i < best.size() && i < top; i++)
+    {
+        printf("%08x played %lu of %lu (%.3f)\n", best[i].first, (unsigned long)best[i].second.played,
+               (unsigned long)best[i].second.seen, double(best[i].second.played) / best[i].second.seen);
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+/* Replays every game of a corpus (directory of SGF files or .sga archive) through Board::make_play.
+   Reports moves our rules reject, counts captures and ko, recounts chains from scratch on a sample of
+   positions, and doubles as a throughput benchmark for the chain management code. */
+#include "GameRecord.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+struct IllegalMove
+{
+    std::string source;
+    uint16_t move_number; // counted from 1 as in the file, without the passes GameRecord inserts
+    uint16_t idx;
+    bool black;
+    playError error;
+};
+
+struct ReplayStats
+{
+    Board board; // reused for every game this worker replays
+
+    uint64_t games = 0;
+    uint64_t moves = 0;
+    uint64_t skipped = 0; // games with setup stones
+    uint64_t capturing_moves = 0;
+    uint64_t captured_stones = 0;
+    uint64_t kos = 0;
+    uint64_t consistency_checks = 0;
+    std::vector<IllegalMove> illegal;
+    std::vector<std::string> inconsistent;
+
+    void add(const ReplayStats &other)
+    {
+        games += other.games;
+        moves += other.moves;
+        skipped += other.skipped;
+        capturing_moves += other.capturing_moves;
+        captured_stones += other.captured_stones;
+        kos += other.kos;
+        consistency_checks += other.consistency_checks;
+        illegal.insert(illegal.end(), other.illegal.begin(), other.illegal.end());
+        inconsistent.insert(inconsistent.end(), other.inconsistent.begin(), other.inconsistent.end());
+    }
+};
+
+static bool sampled(uint64_t hash, uint16_t move_number, double fraction)
+{
+    // decided by the position so reruns check the same positions
+    uint64_t mixed = (hash ^ move_number) * 0x9e3779b97f4a7c15;
+    return double(mixed >> 11) / double(1ULL << 53) < fraction;
+}
+
+static void replay_game(const GameRecord &record, ReplayStats &stats, double check_fraction)
+{
+    if (record.has_setup())
+    {
+        stats.skipped++;
+        return;
+    }
+    stats.games++;
+    Board &b = stats.board;
+    b = Board();
+
+    for (uint16_t i = 0; i < record.moves.size(); i++)
+    {
+        uint16_t move = record.moves[i];
+        bool black = b.whose_turn();
+        if (move == PASS)
+        {
+            b.make_play(PASS);
+            continue;
+        }
+
+        std::array<pointType, 4> neighbors_before;
+        for (uint16_t d = 0; d < 4; d++)
+        {
+            neighbors_before[d] = b.get_point(move + b.directions[d]);
+        }
+        uint16_t opponent_stones = b.get_stone_count(!black);
+
+        if (!b.make_play(move))
+        {
+            stats.illegal.push_back(IllegalMove{record.source, record.record_move_number(i), move, black, b.get_play_error(move)});
+            return;
+        }
+        stats.moves++;
+
+        uint16_t captured = opponent_stones - b.get_stone_count(!black);
+        if (captured)
+        {
+            stats.capturing_moves++;
+            stats.captured_stones += captured;
+        }
+        if (captured == 1)
+        {
+            // a single stone capture is a ko if the immediate recapture is now forbidden
+            pointType opponent = black ? pointType::WHITE : pointType::BLACK;
+            for (uint16_t d = 0; d < 4; d++)
+            {
+                uint16_t neighbor = move + b.directions[d];
+                if (neighbors_before[d] == opponent && b.get_point(neighbor) == pointType::EMPTY)
+                {
+                    stats.kos += b.get_play_error(neighbor) == PLAY_KO;
+                    break;
+                }
+            }
+        }
+
+        if (sampled(b.get_hash(), i, check_fraction))
+        {
+            stats.consistency_checks++;
+            if (!b.is_consistent())
+            {
+                stats.inconsistent.push_back(record.source + " move " + std::to_string(record.record_move_number(i)));
+                return;
+            }
+        }
+    }
+}
+
+static std::string sgf_point(uint16_t idx)
+{
+    std::pair<int, int> coords = Board::idx_to_coords(idx);
+    return std::string(1, char('a' + coords.second)) + char('a' + coords.first);
+}
+
+int main(int argc, char **argv)
+{
+    std::string games = path_to_games;
+    uint16_t num_threads = 0;
+    double check_fraction = 0.01;
+    uint32_t max_reports = 50;
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--threads") && has_value)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--check-fraction") && has_value)
+        {
+            check_fraction = std::strtod(argv[++i], nullptr);
+        }
+        else if (!strcmp(argv[i], "--max-reports") && has_value)
+        {
+            max_reports = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argv[i][0] != '-')
+        {
+            games = argv[i];
+        }
+        else
+        {
+            printf("usage: %s [games directory or archive.sga] [--threads N] [--check-fraction F] [--max-reports N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ReplayStats stats = scan_records<ReplayStats>(games, num_threads, [check_fraction](const GameRecord &record, ReplayStats &thread_stats)
+                                                  { replay_game(record, thread_stats, check_fraction); });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    static const std::array<const char *, 4> error_names = {"ok", "occupied", "suicide", "ko"};
+    std::sort(stats.illegal.begin(), stats.illegal.end(), [](const IllegalMove &a, const IllegalMove &b)
+              { return a.source < b.source; });
+    for (uint32_t i = 0; i < stats.illegal.size() && i < max_reports; i++)
+    {
+        const IllegalMove &m = stats.illegal[i];
+        printf("illegal: %s move %u %c[%s] %s\n", m.source.c_str(), m.move_number, m.black ? 'B' : 'W', sgf_point(m.idx).c_str(), error_names[m.error]);
+    }
+    for (uint32_t i = 0; i < stats.inconsistent.size() && i < max_reports; i++)
+    {
+        printf("inconsistent chains: %s\n", stats.inconsistent[i].c_str());
+    }
+
+    printf("%lu games (%lu skipped with setup stones), %lu moves in %.2fs: %.0f games/s, %.0f moves/s\n",
+           (unsigned long)stats.games, (unsigned long)stats.skipped, (unsigned long)stats.moves, seconds,
+           stats.games / seconds, stats.moves / seconds);
+    printf("%lu capturing moves (%lu stones), %lu kos\n", (unsigned long)stats.capturing_moves,
+           (unsigned long)stats.captured_stones, (unsigned long)stats.kos);
+    printf("%lu games with illegal moves, %lu of %lu sampled positions inconsistent\n", (unsigned long)stats.illegal.size(),
+           (unsigned long)stats.inconsistent.size(), (unsigned long)stats.consistency_checks);
+    return stats.illegal.empty() && stats.inconsistent.empty() ? 0 : 2;
+}
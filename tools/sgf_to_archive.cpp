@@ -0,0 +1,70 @@
+/* Converts a directory of SGF files into a binary game archive (see GameArchive.h). */
+#include "CorpusScan.h"
+#include "GameArchive.h"
+
+#include <cstdlib>
+#include <cstring>
+
+struct ConvertStats
+{
+    uint64_t written = 0;
+    uint64_t failed = 0;
+
+    void add(const ConvertStats &other)
+    {
+        written += other.written;
+        failed += other.failed;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    std::string games = path_to_games;
+    std::string output = "games.sga";
+    uint16_t num_threads = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+        {
+            output = argv[++i];
+        }
+        else if (argv[i][0] != '-')
+        {
+            games = argv[i];
+        }
+        else
+        {
+            printf("usage: %s [games directory] [-o archive] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    GameArchiveWriter writer(output);
+    if (!writer.is_open())
+    {
+        return 1;
+    }
+    ConvertStats stats = scan_corpus<ConvertStats>(games, num_threads, [&](const SGFFile &file, ConvertStats &thread_stats)
+                                                   {
+        if (writer.add_game(file))
+        {
+            thread_stats.written++;
+        }
+        else
+        {
+            thread_stats.failed++;
+        } });
+    if (!writer.close())
+    {
+        std::cout << "Failed to write archive " << output << '\n';
+        return 1;
+    }
+    printf("wrote %lu games to %s (%lu failed)\n", (unsigned long)stats.written, output.c_str(), (unsigned long)stats.failed);
+
+    GameArchive archive(output);
+    return archive.is_valid() && archive.num_games() == stats.written ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+/* Solves a position exactly: the score with perfect play from both sides and the line that gets there.
+   Meant for tiny boards, built with make solve SOLVE_SIZE=3, and for closed-off regions of a normal
+   board given with --region. The position is a list of GTP moves from the empty board. */
+#include "GTPEngine.h"
+#include "Solver.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+// every point in the rectangle with corners from and to, e.g. A1:D4
+static bool parse_region(const std::string &text, std::vector<uint16_t> &points)
+{
+    size_t colon = text.find(':');
+    uint16_t from;
+    uint16_t to;
+    if (colon == std::string::npos || !parse_gtp_vertex(text.substr(0, colon), from) || !parse_gtp_vertex(text.substr(colon + 1), to) ||
+        from == PASS || to == PASS)
+    {
+        return false;
+    }
+    std::pair<int, int> a = Board::idx_to_coords(from);
+    std::pair<int, int> b = Board::idx_to_coords(to);
+    for (int row = std::min(a.first, b.first); row <= std::max(a.first, b.first); row++)
+    {
+        for (int column = std::min(a.second, b.second); column <= std::max(a.second, b.second); column++)
+        {
+            points.push_back(Board::coords_to_idx(column, row));
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    std::string moves;
+    std::vector<uint16_t> region;
+    size_t hash_megabytes = 256;
+    uint64_t max_nodes = 0;
+    uint16_t max_ply = 0;
+    float game_komi = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--moves") && has_value)
+        {
+            moves = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--region") && has_value)
+        {
+            if (!parse_region(argv[++i], region))
+            {
+                printf("Bad region %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--hash") && has_value)
+        {
+            hash_megabytes = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--nodes") && has_value)
+        {
+            max_nodes = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--max-ply") && has_value)
+        {
+            max_ply = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--komi") && has_value)
+        {
+            game_komi = std::strtod(argv[++i], nullptr);
+        }
+        else
+        {
+            printf("usage: %s [--moves \"D4 C3 ...\"] [--region A1:E5] [--hash MB] [--nodes N] [--max-ply N] [--komi K]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Board b;
+    std::istringstream words(moves);
+    for (std::string word; words >> word;)
+    {
+        uint16_t idx;
+        if (!parse_gtp_vertex(word, idx) || !b.make_play(idx))
+        {
+            printf("Can't play %s\n", word.c_str());
+            return 1;
+        }
+    }
+
+    Solver solver(hash_megabytes);
+    solver.set_region(region);
+    solver.set_max_ply(max_ply);
+    solver.set_node_limit(max_nodes);
+    printf("solving %dx%d, %zu points, %s to move\n", BOARD_SIZE, BOARD_SIZE, region.empty() ? size_t(BOARD_SIZE * BOARD_SIZE) : region.size(),
+           b.whose_turn() ? "black" : "white");
+    auto start = std::chrono::steady_clock::now();
+    SolveResult result = solver.solve(b);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!result.complete)
+    {
+        printf("stopped after %lu nodes in %.2fs, %lu lines cut at the ply limit\n", result.nodes, seconds, result.truncated);
+        return 2;
+    }
+    if (!result.exact)
+    {
+        // the ply limit decided some lines, so the true score is only known to lie between the bounds
+        printf("unresolved, score between %+d and %+d\n", result.lower, result.upper);
+        printf("%lu nodes in %.2fs, %lu lines cut at the ply limit\n", result.nodes, seconds, result.truncated);
+        return 2;
+    }
+
+    std::string line;
+    for (uint16_t move : result.line)
+    {
+        line += (line.empty() ? "" : " ") + gtp_vertex(move);
+    }
+    float margin = result.score - game_komi;
+    char outcome[32] = "draw";
+    if (margin != 0)
+    {
+        snprintf(outcome, sizeof(outcome), "%c+%g", margin > 0 ? 'B' : 'W', std::fabs(margin));
+    }
+    printf("score %+d, %s with komi %g\n", result.score, outcome, game_komi);
+    printf("line %s\n", line.c_str());
+    printf("%lu nodes in %.2fs, %.0f nodes/s, %lu lines cut at the ply limit\n", result.nodes, seconds, result.nodes / seconds, result.truncated);
+    return 0;
+}
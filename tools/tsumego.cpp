@@ -0,0 +1,252 @@
+/* Solves a directory of life and death problems with LifeSolver and reports how many positions it
+   settles per second. Each SGF holds one problem: the setup stones, the side to move from PL or else
+   the colour of the first move, and the main line as the expected answer. By default the side to move
+   attacks and has to capture the largest chain of the other colour; with --live it defends its own
+   largest chain, and with --two-eyes seki no longer counts as living. Moves are limited to the stones'
+   bounding box. Problems from a bigger board are moved into the matching corner or side
+   of this one when they fit without coming closer to another edge. */
+#include "CorpusScan.h"
+#include "GTPEngine.h"
+#include "LifeSolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+// filled in from the command line before scanning, read only afterwards
+static size_t hash_megabytes = 16;
+static uint64_t max_nodes = 1000000;
+static bool defend = false;
+static lifeGoal goal = GOAL_CAPTURE;
+static bool quiet = false;
+
+// per thread statistics for scan_corpus, with the thread's own solver
+struct TsumegoStats
+{
+    uint64_t problems = 0;
+    uint64_t won = 0; // for the side to move
+    uint64_t lost = 0;
+    uint64_t unsolved = 0; // stopped by the node limit
+    uint64_t skipped = 0;  // didn't fit on the board or had no target
+    uint64_t with_answer = 0;
+    uint64_t agreed = 0; // won with the main line's first move
+    uint64_t nodes = 0;
+    double seconds = 0; // spent in the solver
+    std::unique_ptr<LifeSolver> solver;
+
+    void add(const TsumegoStats &other)
+    {
+        problems += other.problems;
+        won += other.won;
+        lost += other.lost;
+        unsolved += other.unsolved;
+        skipped += other.skipped;
+        with_answer += other.with_answer;
+        agreed += other.agreed;
+        nodes += other.nodes;
+        seconds += other.seconds;
+    }
+};
+
+// how far to move a problem along one axis, low and high are the extent of its stones; false if it
+// can't be placed without touching an edge it didn't or leaving one it did
+static bool axis_offset(int low, int high, int size, int &offset)
+{
+    bool near_low = low <= 1;
+    bool near_high = high >= size - 2;
+    offset = near_high && !near_low ? BOARD_SIZE - size : 0;
+    return low + offset >= 0 && high + offset < BOARD_SIZE && (low + offset <= 1) == near_low && (high + offset >= BOARD_SIZE - 2) == near_high;
+}
+
+static uint16_t chain_size(const Board &b, uint16_t idx, std::array<bool, NUM_POINTS> &seen)
+{
+    std::array<uint16_t, NUM_POINTS> chain;
+    chain[0] = idx;
+    seen[idx] = true;
+    uint16_t size = 1;
+    for (uint16_t next = 0; next < size; next++)
+    {
+        for (int direction : b.directions)
+        {
+            uint16_t neighbor = chain[next] + direction;
+            if (!seen[neighbor] && b.get_point(neighbor) == b.get_point(idx))
+            {
+                seen[neighbor] = true;
+                chain[size++] = neighbor;
+            }
+        }
+    }
+    return size;
+}
+
+static void solve_problem(const SGFFile &file, TsumegoStats &stats)
+{
+    const std::vector<SGFMove> &setup = file.get_setup();
+    const std::vector<SGFMove> &moves = file.get_moves();
+    int low_x = file.get_size();
+    int low_y = file.get_size();
+    int high_x = -1;
+    int high_y = -1;
+    for (const std::vector<SGFMove> *stones : {&setup, &moves})
+    {
+        for (const SGFMove &stone : *stones)
+        {
+            if (stone.x != SGF_PASS)
+            {
+                low_x = std::min<int>(low_x, stone.x);
+                low_y = std::min<int>(low_y, stone.y);
+                high_x = std::max<int>(high_x, stone.x);
+                high_y = std::max<int>(high_y, stone.y);
+            }
+        }
+    }
+    int dx;
+    int dy;
+    if (high_x < 0 || !axis_offset(low_x, high_x, file.get_size(), dx) || !axis_offset(low_y, high_y, file.get_size(), dy))
+    {
+        stats.skipped++;
+        return;
+    }
+
+    bool black_to_move = file.get_player() ? file.get_player() > 0 : moves.empty() || moves[0].black;
+    std::array<pointType, NUM_POINTS> stones{};
+    for (const SGFMove &stone : setup)
+    {
+        stones[Board::coords_to_idx(stone.x + dx, stone.y + dy)] = stone.black ? pointType::BLACK : pointType::WHITE;
+    }
+    Board b;
+    if (!b.set_position(stones, black_to_move ? 0 : 1))
+    {
+        stats.skipped++;
+        return;
+    }
+
+    // the largest chain of the defender's colour
+    pointType defender = black_to_move == defend ? pointType::BLACK : pointType::WHITE;
+    std::array<bool, NUM_POINTS> seen{};
+    uint16_t target = PASS;
+    uint16_t target_size = 0;
+    for (uint16_t i = 0; i < NUM_POINTS; i++)
+    {
+        if (b.get_point(i) == defender && !seen[i])
+        {
+            uint16_t size = chain_size(b, i, seen);
+            target = size > target_size ? i : target;
+            target_size = std::max(target_size, size);
+        }
+    }
+    if (target == PASS)
+    {
+        stats.skipped++;
+        return;
+    }
+
+    std::vector<uint16_t> region;
+    // the attacker's wall closes the problem off, points outside it would only give the defender
+    // pointless moves to try
+    for (int y = low_y + dy; y <= high_y + dy; y++)
+    {
+        for (int x = low_x + dx; x <= high_x + dx; x++)
+        {
+            region.push_back(Board::coords_to_idx(x, y));
+        }
+    }
+    if (!stats.solver)
+    {
+        stats.solver = std::make_unique<LifeSolver>(hash_megabytes);
+        stats.solver->set_node_limit(max_nodes);
+    }
+    stats.solver->set_region(region);
+    auto start = std::chrono::steady_clock::now();
+    LifeResult result = stats.solver->solve(b, target, goal);
+    stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    stats.problems++;
+    stats.nodes += result.nodes;
+    stats.won += result.status == LIFE_WIN;
+    stats.lost += result.status == LIFE_LOSS;
+    stats.unsolved += result.status == LIFE_UNKNOWN;
+    uint16_t answer = PASS;
+    bool has_answer = !moves.empty() && moves[0].black == black_to_move && moves[0].x != SGF_PASS;
+    if (has_answer)
+    {
+        answer = Board::coords_to_idx(moves[0].x + dx, moves[0].y + dy);
+        stats.with_answer++;
+        stats.agreed += result.status == LIFE_WIN && result.move == answer;
+    }
+    if (quiet)
+    {
+        return;
+    }
+
+    const char *outcome = result.status == LIFE_UNKNOWN ? "unsolved" : result.status == LIFE_LOSS ? "fails" : defend ? "lives" : "kills";
+    std::string line = file.get_path() + " " + outcome;
+    if (result.status == LIFE_WIN)
+    {
+        line += " with " + gtp_vertex(result.move);
+    }
+    line += ", " + std::to_string(result.nodes) + " nodes";
+    if (has_answer && result.status == LIFE_WIN)
+    {
+        line += result.move == answer ? ", as the answer" : ", the answer is " + gtp_vertex(answer);
+    }
+    printf("%s\n", line.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    std::string problems = "tsumego";
+    uint16_t num_threads = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--threads") && has_value)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--hash") && has_value)
+        {
+            hash_megabytes = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--nodes") && has_value)
+        {
+            max_nodes = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--live"))
+        {
+            defend = true;
+        }
+        else if (!strcmp(argv[i], "--two-eyes"))
+        {
+            goal = GOAL_LIVE;
+        }
+        else if (!strcmp(argv[i], "--quiet"))
+        {
+            quiet = true;
+        }
+        else if (argv[i][0] != '-')
+        {
+            problems = argv[i];
+        }
+        else
+        {
+            printf("usage: %s [problems directory] [--threads N] [--hash MB per thread] [--nodes N per problem] [--live] [--two-eyes] [--quiet]\n", argv[0]);
+            return 1;
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+    TsumegoStats stats = scan_corpus<TsumegoStats>(problems, num_threads, solve_problem, false);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t solved = stats.won + stats.lost;
+    printf("%lu problems in %.2fs, %lu skipped: %lu solved (%lu %s, %lu %s), %lu unsolved\n", (unsigned long)stats.problems, seconds,
+           (unsigned long)stats.skipped, (unsigned long)solved, (unsigned long)stats.won, defend ? "live" : "killed", (unsigned long)stats.lost,
+           defend ? "die" : "survive", (unsigned long)stats.unsolved);
+    // the solver's own time leaves out reading files and waiting for the scan to finish
+    printf("%.1f positions solved/s, %.1f per second of solver time, %.0f nodes/s\n", seconds > 0 ? solved / seconds : 0.0,
+           stats.seconds > 0 ? solved / stats.seconds : 0.0, stats.seconds > 0 ? stats.nodes / stats.seconds : 0.0);
+    printf("first move as the answer in %lu of %lu\n", (unsigned long)stats.agreed, (unsigned long)stats.with_answer);
+    return 0;
+}
@@ -0,0 +1,188 @@
+/* Fits the evaluation weights (see Evaluator.h) to game results. Every position of every game with a
+   known winner becomes a sample, and the weights are chosen by logistic regression so that the score
+   predicts who went on to win: P(black wins) = 1 / (1 + exp(-score / scale)). The scale keeps the
+   weights in points, so the tuned score can stand in for Board::score directly. About one game in ten
+   is held out and only used to report how well the fit generalises. */
+#include "Evaluator.h"
+#include "GameRecord.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+struct FitQuality
+{
+    double loss;     // mean log loss
+    double accuracy; // samples where the sign of the score matched the winner
+};
+
+static FitQuality measure(const std::vector<EvalFeatures> &features, const std::vector<int8_t> &results, const EvalFeatures &weights, double scale)
+{
+    double loss = 0;
+    uint64_t correct = 0;
+    for (size_t i = 0; i < features.size(); i++)
+    {
+        double score = Evaluator::dot(features[i], weights);
+        double p = 1 / (1 + std::exp(-score / scale));
+        p = std::min(std::max(p, 1e-9), 1 - 1e-9);
+        loss -= results[i] > 0 ? std::log(p) : std::log(1 - p);
+        correct += (score > 0) == (results[i] > 0);
+    }
+    size_t count = std::max<size_t>(features.size(), 1);
+    return FitQuality{loss / count, double(correct) / count};
+}
+
+// full batch gradient descent with Adam steps, on features divided by their root mean square so one
+// learning rate suits all of them
+static EvalFeatures fit(const TuningSet &set, EvalFeatures weights, double scale, uint32_t epochs, double rate, double l2)
+{
+    std::array<double, NUM_FEATURES> rms{};
+    for (const EvalFeatures &features : set.features)
+    {
+        for (uint16_t j = 0; j < NUM_FEATURES; j++)
+        {
+            rms[j] += double(features[j]) * features[j];
+        }
+    }
+    std::array<double, NUM_FEATURES> u{};
+    for (uint16_t j = 0; j < NUM_FEATURES; j++)
+    {
+        rms[j] = rms[j] > 0 ? std::sqrt(rms[j] / set.features.size()) : 1;
+        u[j] = weights[j] * rms[j];
+    }
+
+    std::array<double, NUM_FEATURES> m{};
+    std::array<double, NUM_FEATURES> v{};
+    const double beta1 = 0.9;
+    const double beta2 = 0.999;
+    for (uint32_t epoch = 1; epoch <= epochs; epoch++)
+    {
+        std::array<double, NUM_FEATURES> gradient{};
+        for (size_t i = 0; i < set.features.size(); i++)
+        {
+            const EvalFeatures &features = set.features[i];
+            double score = Evaluator::dot(features, weights);
+            double error = 1 / (1 + std::exp(-score / scale)) - (set.results[i] > 0);
+            for (uint16_t j = 0; j < NUM_USED_FEATURES; j++)
+            {
+                gradient[j] += error * features[j] / rms[j];
+            }
+        }
+        for (uint16_t j = 0; j < NUM_USED_FEATURES; j++)
+        {
+            double g = gradient[j] / (scale * set.features.size()) + l2 * u[j];
+            m[j] = beta1 * m[j] + (1 - beta1) * g;
+            v[j] = beta2 * v[j] + (1 - beta2) * g * g;
+            double m_hat = m[j] / (1 - std::pow(beta1, epoch));
+            double v_hat = v[j] / (1 - std::pow(beta2, epoch));
+            u[j] -= rate * m_hat / (std::sqrt(v_hat) + 1e-8);
+            weights[j] = u[j] / rms[j];
+        }
+    }
+    return weights;
+}
+
+int main(int argc, char **argv)
+{
+    std::string games = path_to_games;
+    std::string output = path_to_weights;
+    std::string start_path;
+    uint16_t num_threads = 0;
+    uint16_t skip_plies = 10;
+    uint32_t epochs = 1000;
+    double rate = 0.05;
+    double scale = 8;
+    double l2 = 1e-4;
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--threads") && has_value)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--skip-plies") && has_value)
+        {
+            skip_plies = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--epochs") && has_value)
+        {
+            epochs = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--rate") && has_value)
+        {
+            rate = std::strtod(argv[++i], nullptr);
+        }
+        else if (!strcmp(argv[i], "--scale") && has_value)
+        {
+            scale = std::strtod(argv[++i], nullptr);
+        }
+        else if (!strcmp(argv[i], "--l2") && has_value)
+        {
+            l2 = std::strtod(argv[++i], nullptr);
+        }
+        else if (!strcmp(argv[i], "--from") && has_value)
+        {
+            start_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-o") && has_value)
+        {
+            output = argv[++i];
+        }
+        else if (argv[i][0] != '-')
+        {
+            games = argv[i];
+        }
+        else
+        {
+            printf("usage: %s [games directory or archive.sga] [-o weights] [--from weights] [--skip-plies N] [--epochs N] [--rate R] [--scale POINTS] [--l2 L] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Evaluator evaluator;
+    if (!start_path.empty() && !evaluator.load(start_path))
+    {
+        printf("Failed to load evaluation weights %s\n", start_path.c_str());
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    TuningSet set = scan_records<TuningSet>(games, num_threads, [skip_plies](const GameRecord &record, TuningSet &thread_set)
+                                            { thread_set.add_game(record, skip_plies); });
+    double scan_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (set.features.empty())
+    {
+        printf("No positions from games with a known winner in %s\n", games.c_str());
+        return 1;
+    }
+    printf("%zu positions to fit and %zu held out, extracted in %.2fs\n", set.features.size(), set.held_out_features.size(), scan_seconds);
+
+    EvalFeatures initial = evaluator.get_weights();
+    FitQuality before = measure(set.features, set.results, initial, scale);
+    FitQuality before_held_out = measure(set.held_out_features, set.held_out_results, initial, scale);
+
+    start = std::chrono::steady_clock::now();
+    EvalFeatures tuned = fit(set, initial, scale, epochs, rate, l2);
+    double fit_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    FitQuality after = measure(set.features, set.results, tuned, scale);
+    FitQuality after_held_out = measure(set.held_out_features, set.held_out_results, tuned, scale);
+
+    printf("%-22s %10s %10s\n", "feature", "before", "after");
+    for (uint16_t j = 0; j < NUM_USED_FEATURES; j++)
+    {
+        printf("%-22s %10.4f %10.4f\n", feature_names[j], initial[j], tuned[j]);
+    }
+    printf("fit:      loss %.4f -> %.4f, winner predicted %.1f%% -> %.1f%%\n", before.loss, after.loss, 100 * before.accuracy, 100 * after.accuracy);
+    printf("held out: loss %.4f -> %.4f, winner predicted %.1f%% -> %.1f%%\n", before_held_out.loss, after_held_out.loss,
+           100 * before_held_out.accuracy, 100 * after_held_out.accuracy);
+    printf("%u epochs in %.2fs\n", epochs, fit_seconds);
+
+    evaluator.set_weights(tuned);
+    if (!evaluator.save(output))
+    {
+        return 1;
+    }
+    printf("wrote %s\n", output.c_str());
+    return 0;
+}